@@ -0,0 +1,84 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Minimal benchmark runner, the counterpart of Tests/Test.h. BENCHMARK(name) registers
+// a function that measures something and prints its figures with report().
+// BenchmarkMain.cpp runs every benchmark, or only those whose name contains the first
+// command line argument. Numbers only mean something in a Release build.
+namespace Benchmark {
+    struct Case {
+        const char* name;
+        void (*function)();
+    };
+
+    inline std::vector<Case>& cases() {
+        static std::vector<Case> all;
+        return all;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, void (*function)()) {
+            cases().push_back(Case{ name, function });
+        }
+    };
+
+    // Runs function repetitions times and returns the fastest run in seconds.
+    template <typename Function>
+    double fastest(int repetitions, Function function) {
+        double best = 0.0;
+        for (int i = 0; i < repetitions; i++) {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (i == 0 || seconds < best) {
+                best = seconds;
+            }
+        }
+        return best;
+    }
+
+    // Stops the optimizer from removing work whose result is otherwise unused.
+    inline void keep(uint64_t value) {
+        static volatile uint64_t sink = 0;
+        sink = sink + value;
+    }
+
+    // Highest resident set size of the process so far. It never goes down, so compare
+    // memory figures of benchmarks run one per process.
+    inline double peakResidentMegabytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+
+    inline void report(const std::string& label, double value, const char* unit, int precision = 3) {
+        std::cout << "  " << std::left << std::setw(52) << label << std::right << std::setw(14)
+            << std::fixed << std::setprecision(precision) << value << " " << unit << "\n";
+    }
+}
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static Benchmark::Registrar name##Registrar(#name, name); \
+    static void name()
@@ -0,0 +1,29 @@
+#include "Benchmark.h"
+#include <cstring>
+#include <exception>
+
+// Usage: Benchmarks [filter]
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+
+    for (const Benchmark::Case& benchmark : Benchmark::cases()) {
+        if (filter && !std::strstr(benchmark.name, filter)) continue;
+
+        std::cout << benchmark.name << "\n";
+        try {
+            benchmark.function();
+        }
+        catch (const std::exception& e) {
+            std::cerr << benchmark.name << ": " << e.what() << "\n";
+            return 1;
+        }
+        run++;
+    }
+
+    if (run == 0) {
+        std::cerr << "No benchmark matches " << (filter ? filter : "") << "\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "Benchmark.h"
+#include "BVH.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    const int VIEWS = 32;
+    const int REPETITIONS = 20;
+
+    // Exhibits spread over a floor whose area grows with their count, so the density
+    // (and roughly the number inside one view) stays that of a museum hall.
+    std::vector<AABB> makeExhibits(int count) {
+        std::mt19937 random(1234);
+        float halfSide = std::sqrt(static_cast<float>(count)) * 2.0f;
+        std::uniform_real_distribution<float> position(-halfSide, halfSide);
+        std::uniform_real_distribution<float> size(0.3f, 1.5f);
+
+        std::vector<AABB> exhibits;
+        for (int i = 0; i < count; i++) {
+            glm::vec3 center(position(random), 0.0f, position(random));
+            glm::vec3 extent(size(random), size(random) * 1.5f, size(random));
+            center.y = extent.y;
+            exhibits.push_back(AABB(center - extent, center + extent));
+        }
+        return exhibits;
+    }
+
+    // A visitor standing in the middle of the hall, turning around.
+    std::vector<Frustum> makeViews() {
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 60.0f);
+        std::vector<Frustum> views;
+        for (int i = 0; i < VIEWS; i++) {
+            float angle = glm::two_pi<float>() * i / VIEWS;
+            glm::vec3 eye(0.0f, 1.7f, 0.0f);
+            glm::vec3 forward(std::sin(angle), -0.1f, std::cos(angle));
+            views.push_back(Frustum(projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f))));
+        }
+        return views;
+    }
+}
+
+// BVH::queryFrustum against testing every exhibit's bounds, as the exhibit count grows.
+BENCHMARK(BVH_FrustumCullingVersusLinearScan) {
+    std::vector<Frustum> views = makeViews();
+
+    for (int count : { 100, 250, 500, 1000, 2500, 5000, 10000 }) {
+        std::vector<AABB> exhibits = makeExhibits(count);
+        BVH tree;
+        for (int i = 0; i < count; i++) {
+            tree.createProxy(exhibits[i], i);
+        }
+
+        uint64_t linearVisible = 0;
+        double linear = Benchmark::fastest(REPETITIONS, [&] {
+            linearVisible = 0;
+            for (const Frustum& frustum : views) {
+                for (const AABB& box : exhibits) {
+                    if (frustum.intersects(box)) linearVisible++;
+                }
+            }
+        });
+
+        uint64_t treeVisible = 0;
+        double bvh = Benchmark::fastest(REPETITIONS, [&] {
+            treeVisible = 0;
+            for (const Frustum& frustum : views) {
+                tree.queryFrustum(frustum, [&treeVisible](int) { treeVisible++; });
+            }
+        });
+
+        // Not timed: every exhibit the scan finds must also come out of the tree.
+        uint64_t missed = 0;
+        std::vector<bool> reported(count);
+        for (const Frustum& frustum : views) {
+            std::fill(reported.begin(), reported.end(), false);
+            tree.queryFrustum(frustum, [&reported](int index) { reported[index] = true; });
+            for (int i = 0; i < count; i++) {
+                if (frustum.intersects(exhibits[i]) && !reported[i]) missed++;
+            }
+        }
+        if (missed > 0) {
+            std::cerr << "BVH missed " << missed << " exhibits found by the linear scan\n";
+        }
+
+        std::string label = std::to_string(count) + " exhibits";
+        Benchmark::report(label + ", linear scan", linear * 1e6 / VIEWS, "us/view");
+        Benchmark::report(label + ", BVH (height " + std::to_string(tree.getHeight()) + ")", bvh * 1e6 / VIEWS, "us/view");
+        Benchmark::report(label + ", speed-up", linear / bvh, "x");
+        // The tree reports fat bounds, so it may keep a few more than the exact scan.
+        Benchmark::report(label + ", visible (linear scan)", static_cast<double>(linearVisible) / VIEWS, "", 1);
+        Benchmark::report(label + ", visible (BVH)", static_cast<double>(treeVisible) / VIEWS, "", 1);
+        Benchmark::report(label + ", missed by BVH", static_cast<double>(missed), "", 0);
+        Benchmark::keep(linearVisible + treeVisible);
+    }
+}
\ No newline at end of file
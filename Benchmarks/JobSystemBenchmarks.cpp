@@ -0,0 +1,124 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace {
+    const int EMPTY_JOBS = 100000;
+    const int REPETITIONS = 5;
+
+    // A few hundred nanoseconds of arithmetic that the compiler cannot fold away.
+    uint64_t work(uint64_t seed, int iterations) {
+        uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+        for (int i = 0; i < iterations; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        return x;
+    }
+
+    // Binary tree of jobs: every inner job spawns two children from its worker, so the
+    // other workers only get work by stealing.
+    void spawnTree(JobSystem& jobs, JobCounter& counter, std::atomic<uint64_t>& result, int depth, uint64_t seed) {
+        if (depth == 0) {
+            result.fetch_add(work(seed, 200), std::memory_order_relaxed);
+            return;
+        }
+        jobs.run([&jobs, &counter, &result, depth, seed] { spawnTree(jobs, counter, result, depth - 1, seed * 2); }, &counter);
+        jobs.run([&jobs, &counter, &result, depth, seed] { spawnTree(jobs, counter, result, depth - 1, seed * 2 + 1); }, &counter);
+    }
+}
+
+// Cost of one empty job, from outside the pool (injection queue) and from inside a
+// worker (its own deque), and of parallelFor with one index per range.
+BENCHMARK(JobSystem_SchedulingOverhead) {
+    JobSystem jobs;
+    Benchmark::report("workers", jobs.getWorkerCount(), "", 0);
+
+    double external = Benchmark::fastest(REPETITIONS, [&jobs] {
+        JobCounter counter;
+        for (int i = 0; i < EMPTY_JOBS; i++) {
+            jobs.run([] {}, &counter);
+        }
+        jobs.wait(counter);
+    });
+    Benchmark::report("empty job submitted externally", external * 1e9 / EMPTY_JOBS, "ns/job");
+
+    double internal = Benchmark::fastest(REPETITIONS, [&jobs] {
+        JobCounter root;
+        jobs.run([&jobs] {
+            JobCounter counter;
+            for (int i = 0; i < EMPTY_JOBS; i++) {
+                jobs.run([] {}, &counter);
+            }
+            jobs.wait(counter);
+        }, &root);
+        jobs.wait(root);
+    });
+    Benchmark::report("empty job submitted from a worker", internal * 1e9 / EMPTY_JOBS, "ns/job");
+
+    double parallelFor = Benchmark::fastest(REPETITIONS, [&jobs] {
+        jobs.parallelFor(EMPTY_JOBS, 1, [](size_t, size_t) {});
+    });
+    Benchmark::report("parallelFor range of one index", parallelFor * 1e9 / EMPTY_JOBS, "ns/range");
+}
+
+// How much of a fan-out workload moves between workers, from JobSystem::getStats().
+BENCHMARK(JobSystem_StealRate) {
+    const int DEPTH = 16;
+    JobSystem jobs;
+    std::atomic<uint64_t> result{ 0 };
+
+    for (int run = 0; run < 2; run++) {
+        jobs.resetStats();
+        JobCounter counter;
+        double seconds = Benchmark::fastest(1, [&] {
+            jobs.run([&] { spawnTree(jobs, counter, result, DEPTH, 1); }, &counter);
+            jobs.wait(counter);
+        });
+        if (run == 0) {
+            continue; // warm-up
+        }
+
+        JobSystemStats stats = jobs.getStats();
+        Benchmark::report("workers", stats.workerCount, "", 0);
+        Benchmark::report("jobs executed", static_cast<double>(stats.jobsExecuted), "", 0);
+        Benchmark::report("jobs stolen", static_cast<double>(stats.jobsStolen), "", 0);
+        Benchmark::report("steal rate", 100.0 * stats.jobsStolen / std::max<uint64_t>(1, stats.jobsExecuted), "% of jobs");
+        Benchmark::report("successful steal attempts",
+            100.0 * stats.jobsStolen / std::max<uint64_t>(1, stats.stealAttempts), "%");
+        Benchmark::report("tree of " + std::to_string(1 << DEPTH) + " leaves", seconds * 1e3, "ms");
+    }
+    Benchmark::keep(result.load());
+}
+
+// Fixed amount of parallelFor work on 1..N threads; the calling thread counts as one.
+BENCHMARK(JobSystem_Scaling) {
+    const size_t ITEMS = 1 << 16;
+    const size_t GRAIN = 256;
+    std::atomic<uint64_t> result{ 0 };
+    auto body = [&result](size_t begin, size_t end) {
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; i++) {
+            sum += work(i, 400);
+        }
+        result.fetch_add(sum, std::memory_order_relaxed);
+    };
+
+    double serial = Benchmark::fastest(REPETITIONS, [&] { body(0, ITEMS); });
+    Benchmark::report("1 thread", serial * 1e3, "ms");
+
+    unsigned int hardwareThreads = std::max(2u, std::thread::hardware_concurrency());
+    for (unsigned int workers = 1; workers < hardwareThreads; workers++) {
+        JobSystem jobs(workers);
+        double seconds = Benchmark::fastest(REPETITIONS, [&] { jobs.parallelFor(ITEMS, GRAIN, body); });
+        std::string threads = std::to_string(workers + 1) + " threads";
+        Benchmark::report(threads, seconds * 1e3, "ms");
+        Benchmark::report(threads + " speed-up", serial / seconds, "x");
+    }
+    Benchmark::keep(result.load());
+}
\ No newline at end of file
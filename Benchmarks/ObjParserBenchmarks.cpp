@@ -0,0 +1,122 @@
+#include "Benchmark.h"
+#include "ObjParser.h"
+#include <fstream>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+// Parse throughput over the shipped Models/ tree. Run "Benchmarks ObjParser_" and
+// "Benchmarks TinyObjLoader_" separately to compare peak memory.
+namespace {
+    const int REPETITIONS = 3;
+
+    struct ShippedModel {
+        const char* obj;
+        const char* directory;
+    };
+
+    const ShippedModel SHIPPED_MODELS[] = {
+        { "../Models/muzeu.obj", "../Models/" },
+        { "../Models/Book_Shelf/bookshelf.obj", "../Models/Book_Shelf/" },
+        { "../Models/Camera/camera.obj", "../Models/Camera/" },
+        { "../Models/Canon/OldShipCannon.obj", "../Models/Canon/" },
+        { "../Models/Chest/chest.obj", "../Models/Chest/" },
+        { "../Models/Lantern/lantern.obj", "../Models/Lantern/" },
+        { "../Models/Medieval_Chest/medieval_chest.obj", "../Models/Medieval_Chest/" },
+        { "../Models/Medieval_Desk/medieval_desk.obj", "../Models/Medieval_Desk/" },
+        { "../Models/Old_Table/old_table.obj", "../Models/Old_Table/" },
+        { "../Models/Stand/stand.obj", "../Models/Stand/" },
+        { "../Models/Sword/sword.obj", "../Models/Sword/" },
+        { "../Models/Table/table.obj", "../Models/Table/" },
+    };
+
+    double shippedMegabytes() {
+        double bytes = 0.0;
+        for (const ShippedModel& model : SHIPPED_MODELS) {
+            std::ifstream file(model.obj, std::ios::binary | std::ios::ate);
+            if (!file) {
+                throw std::runtime_error(std::string("Missing model: ") + model.obj);
+            }
+            bytes += static_cast<double>(file.tellg());
+        }
+        return bytes / (1024.0 * 1024.0);
+    }
+
+    void reportParse(double seconds, uint64_t corners) {
+        double megabytes = shippedMegabytes();
+        Benchmark::report("models", sizeof(SHIPPED_MODELS) / sizeof(SHIPPED_MODELS[0]), "", 0);
+        Benchmark::report("OBJ data", megabytes, "MB");
+        Benchmark::report("face corners", static_cast<double>(corners), "", 0);
+        Benchmark::report("parse time", seconds * 1e3, "ms");
+        Benchmark::report("throughput", megabytes / seconds, "MB/s");
+        Benchmark::report("peak resident memory", Benchmark::peakResidentMegabytes(), "MB");
+    }
+
+    uint64_t parseWithObjParser(JobSystem* jobs) {
+        uint64_t corners = 0;
+        for (const ShippedModel& model : SHIPPED_MODELS) {
+            ObjParser::Result result = ObjParser::load(model.obj, model.directory, jobs);
+            for (const ObjParser::Mesh& mesh : result.meshes) {
+                corners += mesh.indices.size();
+            }
+        }
+        return corners;
+    }
+}
+
+BENCHMARK(ObjParser_ParseShippedModels) {
+    uint64_t corners = 0;
+    double seconds = Benchmark::fastest(REPETITIONS, [&corners] { corners = parseWithObjParser(nullptr); });
+    reportParse(seconds, corners);
+}
+
+BENCHMARK(ObjParser_ParseShippedModelsOnJobs) {
+    JobSystem jobs;
+    uint64_t corners = 0;
+    double seconds = Benchmark::fastest(REPETITIONS, [&] { corners = parseWithObjParser(&jobs); });
+    Benchmark::report("workers", jobs.getWorkerCount(), "", 0);
+    reportParse(seconds, corners);
+}
+
+// The loader the engine used before ObjParser, including building the same
+// interleaved vertex arrays from its output.
+BENCHMARK(TinyObjLoader_ParseShippedModels) {
+    uint64_t corners = 0;
+    double seconds = Benchmark::fastest(REPETITIONS, [&corners] {
+        corners = 0;
+        for (const ShippedModel& model : SHIPPED_MODELS) {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+            if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, model.obj, model.directory)) {
+                throw std::runtime_error(warn + err);
+            }
+            for (const auto& shape : shapes) {
+                std::vector<float> vertices;
+                vertices.reserve(shape.mesh.indices.size() * 8);
+                for (const auto& index : shape.mesh.indices) {
+                    const float* position = &attrib.vertices[3 * index.vertex_index];
+                    vertices.insert(vertices.end(), position, position + 3);
+                    if (index.normal_index >= 0) {
+                        const float* normal = &attrib.normals[3 * index.normal_index];
+                        vertices.insert(vertices.end(), normal, normal + 3);
+                    }
+                    else {
+                        vertices.insert(vertices.end(), { 0.0f, 1.0f, 0.0f });
+                    }
+                    if (index.texcoord_index >= 0) {
+                        const float* texcoord = &attrib.texcoords[2 * index.texcoord_index];
+                        vertices.insert(vertices.end(), texcoord, texcoord + 2);
+                    }
+                    else {
+                        vertices.insert(vertices.end(), { 0.0f, 0.0f });
+                    }
+                }
+                corners += shape.mesh.indices.size();
+                Benchmark::keep(vertices.size());
+            }
+        }
+    });
+    reportParse(seconds, corners);
+}
\ No newline at end of file
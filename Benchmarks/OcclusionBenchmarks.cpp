@@ -0,0 +1,97 @@
+#include "Benchmark.h"
+#include "OcclusionBuffer.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    const int ROOMS = 6;
+    const float ROOM_SIZE = 10.0f;
+    const int EXHIBITS = 2000;
+    const int REPETITIONS = 50;
+
+    void addBox(std::vector<glm::vec3>& triangles, const glm::vec3& min, const glm::vec3& max) {
+        glm::vec3 c[8];
+        for (int i = 0; i < 8; i++) {
+            c[i] = glm::vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+        }
+        const int faces[6][4] = { { 0, 1, 3, 2 }, { 4, 6, 7, 5 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+        for (const auto& face : faces) {
+            triangles.insert(triangles.end(), { c[face[0]], c[face[1]], c[face[2]], c[face[0]], c[face[2]], c[face[3]] });
+        }
+    }
+
+    // Walls of a ROOMS x ROOMS grid of halls, each with a doorway in the middle.
+    std::vector<glm::vec3> makeOccluders() {
+        const float height = 4.0f;
+        const float thickness = 0.2f;
+        const float door = 1.5f;
+        std::vector<glm::vec3> triangles;
+        for (int line = 0; line <= ROOMS; line++) {
+            float offset = line * ROOM_SIZE;
+            for (int room = 0; room < ROOMS; room++) {
+                float start = room * ROOM_SIZE;
+                float middle = start + ROOM_SIZE * 0.5f;
+                float end = start + ROOM_SIZE;
+                addBox(triangles, glm::vec3(start, 0.0f, offset), glm::vec3(middle - door * 0.5f, height, offset + thickness));
+                addBox(triangles, glm::vec3(middle + door * 0.5f, 0.0f, offset), glm::vec3(end, height, offset + thickness));
+                addBox(triangles, glm::vec3(offset, 0.0f, start), glm::vec3(offset + thickness, height, middle - door * 0.5f));
+                addBox(triangles, glm::vec3(offset, 0.0f, middle + door * 0.5f), glm::vec3(offset + thickness, height, end));
+            }
+        }
+        return triangles;
+    }
+
+    std::vector<AABB> makeExhibits() {
+        std::mt19937 random(99);
+        std::uniform_real_distribution<float> position(0.5f, ROOMS * ROOM_SIZE - 0.5f);
+        std::uniform_real_distribution<float> size(0.2f, 0.8f);
+        std::vector<AABB> exhibits;
+        for (int i = 0; i < EXHIBITS; i++) {
+            glm::vec3 center(position(random), 0.0f, position(random));
+            glm::vec3 extent(size(random), size(random) * 2.0f, size(random));
+            center.y = extent.y;
+            exhibits.push_back(AABB(center - extent, center + extent));
+        }
+        return exhibits;
+    }
+}
+
+// Cost of one occlusion pass, split as in Scene: rasterizing a fixed set of wall
+// occluders, building the depth hierarchy and testing exhibit bounds against it.
+BENCHMARK(OcclusionBuffer_RasterizeAndTest) {
+    std::vector<glm::vec3> occluders = makeOccluders();
+    std::vector<AABB> exhibits = makeExhibits();
+
+    // Standing in a corner hall, looking diagonally across the building.
+    glm::vec3 eye(ROOM_SIZE * 0.5f, 1.7f, ROOM_SIZE * 0.5f);
+    glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(1.0f, -0.05f, 0.8f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    glm::mat4 viewProjection = projection * view;
+
+    OcclusionBuffer buffer;
+    double rasterize = Benchmark::fastest(REPETITIONS, [&] {
+        buffer.clear(viewProjection);
+        buffer.rasterize(occluders);
+    });
+    double hierarchy = Benchmark::fastest(REPETITIONS, [&] { buffer.buildHierarchy(); });
+
+    int visible = 0;
+    double test = Benchmark::fastest(REPETITIONS, [&] {
+        visible = 0;
+        for (const AABB& box : exhibits) {
+            if (buffer.isVisible(box)) visible++;
+        }
+    });
+
+    size_t triangleCount = occluders.size() / 3;
+    Benchmark::report("occluder triangles", static_cast<double>(triangleCount), "", 0);
+    Benchmark::report("clear + rasterize", rasterize * 1e6, "us");
+    Benchmark::report("rasterize per triangle", rasterize * 1e9 / triangleCount, "ns");
+    Benchmark::report("build hierarchy", hierarchy * 1e6, "us");
+    Benchmark::report("test " + std::to_string(EXHIBITS) + " boxes", test * 1e6, "us");
+    Benchmark::report("test per box", test * 1e9 / EXHIBITS, "ns");
+    Benchmark::report("boxes occluded", 100.0 * (EXHIBITS - visible) / EXHIBITS, "%");
+    Benchmark::report("whole pass", (rasterize + hierarchy + test) * 1e3, "ms");
+}
\ No newline at end of file
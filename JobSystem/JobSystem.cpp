@@ -0,0 +1,296 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    thread_local JobSystem* currentSystem = nullptr;
+    thread_local int currentWorker = -1;
+    thread_local unsigned int stealSeed = 0;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) {
+    if (workerCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for (unsigned int i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned int i = 0; i < workerCount; i++) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void JobSystem::workerLoop(unsigned int index) {
+    currentSystem = this;
+    currentWorker = static_cast<int>(index);
+    stealSeed = index * 2654435761u + 1;
+
+    while (true) {
+        Job job;
+        if (tryPop(job)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeCondition.wait(lock, [this] { return stopping.load() || queuedJobs.load() > 0; });
+        if (stopping) {
+            break;
+        }
+    }
+
+    currentSystem = nullptr;
+    currentWorker = -1;
+}
+
+void JobSystem::push(Job job) {
+    if (currentSystem == this && currentWorker >= 0) {
+        Worker& worker = *workers[currentWorker];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+    }
+    else {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        injectionQueue.push_back(std::move(job));
+        externalSubmissions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    queuedJobs.fetch_add(1);
+    // Taking the lock orders this push against a worker that is about to sleep.
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wakeCondition.notify_one();
+}
+
+bool JobSystem::tryPop(Job& job) {
+    if (currentSystem == this && currentWorker >= 0) {
+        Worker& worker = *workers[currentWorker];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+            queuedJobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (!injectionQueue.empty()) {
+            job = std::move(injectionQueue.front());
+            injectionQueue.pop_front();
+            queuedJobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    unsigned int thief = currentSystem == this && currentWorker >= 0
+        ? static_cast<unsigned int>(currentWorker)
+        : getWorkerCount();
+    return trySteal(thief, job);
+}
+
+bool JobSystem::trySteal(unsigned int thief, Job& job) {
+    unsigned int count = getWorkerCount();
+    if (count == 0 || queuedJobs.load() == 0) {
+        return false;
+    }
+
+    stealSeed = stealSeed * 1664525u + 1013904223u;
+    unsigned int start = stealSeed % count;
+
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int victimIndex = (start + i) % count;
+        if (victimIndex == thief) {
+            continue;
+        }
+
+        if (thief < count) {
+            workers[thief]->stealAttempts.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Worker& victim = *workers[victimIndex];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queuedJobs.fetch_sub(1);
+            if (thief < count) {
+                workers[thief]->stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::tryRunOne() {
+    Job job;
+    if (!tryPop(job)) {
+        return false;
+    }
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(Job& job) {
+    // The counter has to finish either way, or everything waiting on it would hang.
+    try {
+        job.function();
+    }
+    catch (...) {
+        if (job.counter) {
+            std::lock_guard<std::mutex> lock(job.counter->continuationMutex);
+            if (!job.counter->exception) {
+                job.counter->exception = std::current_exception();
+            }
+        }
+        else {
+            // Nobody waits for this job, so there is nowhere to rethrow.
+            try {
+                throw;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Unhandled exception in job: " << e.what() << "\n";
+            }
+            catch (...) {
+                std::cerr << "Unhandled exception in job\n";
+            }
+        }
+    }
+
+    if (currentSystem == this && currentWorker >= 0) {
+        workers[currentWorker]->executed.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        externalExecuted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    finish(job.counter);
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter) {
+        return;
+    }
+
+    // The decrement happens under the counter's mutex and wait() takes that mutex
+    // before returning, so a waiter cannot destroy the counter while we still use it.
+    std::vector<std::pair<JobFunction, JobCounter*>> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->continuationMutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        ready.swap(counter->continuations);
+    }
+    for (auto& continuation : ready) {
+        push(Job{ std::move(continuation.first), continuation.second });
+    }
+}
+
+void JobSystem::run(JobFunction function, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    push(Job{ std::move(function), counter });
+}
+
+void JobSystem::runAfter(JobCounter& dependency, JobFunction function, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(dependency.continuationMutex);
+        if (!dependency.isDone()) {
+            dependency.continuations.emplace_back(std::move(function), counter);
+            return;
+        }
+    }
+    push(Job{ std::move(function), counter });
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while (!counter.isDone()) {
+        if (!tryRunOne()) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(counter.continuationMutex);
+        exception.swap(counter.exception);
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        grainSize = std::max<size_t>(1, count / ((getWorkerCount() + 1) * 4));
+    }
+    if (count <= grainSize) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = grainSize; begin < count; begin += grainSize) {
+        size_t end = std::min(begin + grainSize, count);
+        run([&body, begin, end] { body(begin, end); }, &counter);
+    }
+
+    // The other ranges reference body and counter, so they must finish before we leave.
+    std::exception_ptr exception;
+    try {
+        body(0, grainSize);
+    }
+    catch (...) {
+        exception = std::current_exception();
+    }
+    wait(counter);
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+JobSystemStats JobSystem::getStats() const {
+    JobSystemStats stats;
+    stats.workerCount = getWorkerCount();
+    stats.jobsExecuted = externalExecuted.load(std::memory_order_relaxed);
+    stats.jobsSubmittedExternally = externalSubmissions.load(std::memory_order_relaxed);
+    for (const auto& worker : workers) {
+        stats.jobsExecuted += worker->executed.load(std::memory_order_relaxed);
+        stats.jobsStolen += worker->stolen.load(std::memory_order_relaxed);
+        stats.stealAttempts += worker->stealAttempts.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void JobSystem::resetStats() {
+    externalExecuted = 0;
+    externalSubmissions = 0;
+    for (auto& worker : workers) {
+        worker->executed = 0;
+        worker->stolen = 0;
+        worker->stealAttempts = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using JobFunction = std::function<void()>;
+
+// Tracks a group of jobs. It is incremented when a job is submitted against it and
+// decremented when that job finishes; jobs submitted with runAfter() start once it
+// drops to zero. A job that throws still finishes; the first exception is kept here
+// and rethrown by JobSystem::wait().
+class JobCounter {
+private:
+    friend class JobSystem;
+
+    std::atomic<int> pending{ 0 };
+    std::mutex continuationMutex;
+    std::vector<std::pair<JobFunction, JobCounter*>> continuations;
+    std::exception_ptr exception;
+
+public:
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+    int getPending() const { return pending.load(std::memory_order_acquire); }
+};
+
+struct JobSystemStats {
+    uint64_t jobsExecuted = 0;
+    uint64_t jobsStolen = 0;
+    uint64_t stealAttempts = 0;
+    uint64_t jobsSubmittedExternally = 0;
+    unsigned int workerCount = 0;
+};
+
+// Fixed pool of worker threads with one work-stealing deque per worker. A worker
+// pushes and pops its own jobs at the back (LIFO, cache-warm) and steals from the
+// front of other workers' deques (FIFO, oldest and usually largest work first).
+// Threads that are not workers submit through a shared injection queue.
+class JobSystem {
+private:
+    struct Job {
+        JobFunction function;
+        JobCounter* counter = nullptr;
+    };
+
+    struct Worker {
+        std::deque<Job> jobs;
+        std::mutex mutex;
+        std::atomic<uint64_t> executed{ 0 };
+        std::atomic<uint64_t> stolen{ 0 };
+        std::atomic<uint64_t> stealAttempts{ 0 };
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::deque<Job> injectionQueue;
+    std::mutex injectionMutex;
+    std::atomic<uint64_t> externalSubmissions{ 0 };
+    std::atomic<uint64_t> externalExecuted{ 0 };
+
+    std::atomic<int> queuedJobs{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> stopping{ false };
+
+    void workerLoop(unsigned int index);
+    void push(Job job);
+    bool tryPop(Job& job);
+    bool trySteal(unsigned int thief, Job& job);
+    bool tryRunOne();
+    void execute(Job& job);
+    void finish(JobCounter* counter);
+
+public:
+    // workerCount == 0 uses one worker per hardware thread, minus the calling thread.
+    explicit JobSystem(unsigned int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(JobFunction function, JobCounter* counter = nullptr);
+
+    // Starts function once dependency reaches zero.
+    void runAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr);
+
+    // Runs other jobs on the calling thread until counter reaches zero, then rethrows
+    // the first exception thrown by one of its jobs.
+    void wait(JobCounter& counter);
+
+    // Splits [0, count) into ranges of at most grainSize and blocks until all are done.
+    // If a range throws, the exception is rethrown once every range has finished.
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& body);
+
+    unsigned int getWorkerCount() const { return static_cast<unsigned int>(workers.size()); }
+    JobSystemStats getStats() const;
+    void resetStats();
+};
\ No newline at end of file
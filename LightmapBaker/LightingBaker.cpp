@@ -0,0 +1 @@
+#include "LightingBaker.h"
\ No newline at end of file
@@ -0,0 +1,389 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BakedLighting.h"
+#include "JobSystem.h"
+#include "LightmapAtlas.h"
+#include "ObjParser.h"
+#include "RayTracer.h"
+#include "SceneDescription.h"
+
+struct BakeSettings {
+    float texelsPerUnit = 16.0f;
+    int maxAtlasSize = 4096;
+    int bounces = 0;            // indirect bounces in the lightmap; probes always get at least one
+    int samples = 64;           // hemisphere rays per texel and per probe face
+    float probeSpacing = 1.0f;
+};
+
+// Bakes what fragment_shader.glsl computes for diffuse surfaces: per light the ambient
+// term plus attenuated Lambert lighting, with shadows from ray casts instead of shadow
+// maps. Models marked static in the scene file get lightmaps, everything that does
+// not rotate casts shadows, and the probes capture the bounced light that exhibits
+// will receive.
+class LightingBaker {
+private:
+    const float SURFACE_BIAS = 0.002f;
+    // Near plane of the light projections in Scene::recordShadowMaps; geometry closer
+    // than this to a light (the ceiling the lights hang from) casts no shadow there.
+    const float SHADOW_NEAR = 1.0f;
+    const float BACKFACE_LIMIT = 0.25f;
+    const float MISS_LIMIT = 0.5f;
+    const int DILATION_PASSES = 2;
+
+    enum class FirstHit { Miss, Front, Back };
+
+    struct StaticMesh {
+        size_t model;
+        size_t atlasMesh;
+    };
+
+    // Small PCG generator; seeded per texel so results do not depend on scheduling.
+    struct Random {
+        uint64_t state;
+
+        explicit Random(uint64_t seed) : state(seed * 6364136223846793005ull + 1442695040888963407ull) {
+        }
+
+        float next() {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            uint32_t xorshifted = static_cast<uint32_t>(((state >> 18u) ^ state) >> 27u);
+            uint32_t rotation = static_cast<uint32_t>(state >> 59u);
+            uint32_t value = (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+            return (value >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    JobSystem& jobs;
+    const SceneDescription& scene;
+    BakeSettings settings;
+
+    RayTracer tracer;
+    std::vector<glm::vec3> materialAlbedo;
+    LightmapAtlas atlas;
+    std::vector<StaticMesh> staticMeshes;
+    std::vector<size_t> staticMeshCounts;       // per scene model, 0 if not lightmapped
+    AABB staticBounds;
+
+    // Same composition as Model::composeMatrix.
+    static glm::mat4 modelMatrix(const ModelDescription& desc) {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, desc.position);
+        model = glm::rotate(model, glm::radians(desc.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(desc.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(desc.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, desc.scale);
+        return model;
+    }
+
+    // Average colour of a texture; the viewer multiplies the lighting by it, so
+    // bounced light is tinted the same way.
+    static glm::vec3 averageColour(const std::string& path) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 3);
+        if (!pixels) {
+            std::cerr << "Warning: could not read " << path << ", using grey for bounced light\n";
+            return glm::vec3(0.5f);
+        }
+        glm::dvec3 sum(0.0);
+        size_t count = static_cast<size_t>(width) * height;
+        for (size_t i = 0; i < count; i++) {
+            sum += glm::dvec3(pixels[i * 3], pixels[i * 3 + 1], pixels[i * 3 + 2]);
+        }
+        stbi_image_free(pixels);
+        return glm::vec3(sum / (255.0 * count));
+    }
+
+    void loadGeometry() {
+        std::vector<ObjParser::Result> parsed(scene.models.size());
+        std::vector<std::string> errors(scene.models.size());
+        jobs.parallelFor(scene.models.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    parsed[i] = ObjParser::load(scene.models[i].objPath, scene.models[i].mtlBaseDir, &jobs);
+                }
+                catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+        });
+
+        std::unordered_map<std::string, int> materials;
+        std::vector<std::string> texturePaths;
+        staticMeshCounts.assign(scene.models.size(), 0);
+
+        for (size_t i = 0; i < scene.models.size(); i++) {
+            const ModelDescription& desc = scene.models[i];
+            if (!errors[i].empty()) {
+                if (desc.required) {
+                    throw std::runtime_error(errors[i]);
+                }
+                std::cerr << "Skipping " << desc.objPath << ": " << errors[i] << "\n";
+                continue;
+            }
+            // Rotating exhibits would leave their shadow behind.
+            bool castsShadows = !desc.hasTag("rotate");
+            bool lightmapped = !desc.exhibit;
+            if (!castsShadows && !lightmapped) continue;
+
+            glm::mat4 matrix = modelMatrix(desc);
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(matrix)));
+            for (const ObjParser::Mesh& mesh : parsed[i].meshes) {
+                std::string texture = mesh.diffuseTexture.empty() ? "../Textures/default.png" : desc.mtlBaseDir + mesh.diffuseTexture;
+                auto inserted = materials.emplace(texture, static_cast<int>(texturePaths.size()));
+                if (inserted.second) {
+                    texturePaths.push_back(texture);
+                }
+
+                size_t cornerCount = mesh.indices.size();
+                std::vector<glm::vec3> positions(cornerCount), normals(cornerCount);
+                for (size_t c = 0; c < cornerCount; c++) {
+                    const float* vertex = &mesh.vertices[mesh.indices[c] * 8];
+                    positions[c] = glm::vec3(matrix * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+                    normals[c] = normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]);
+                    if (lightmapped) {
+                        staticBounds.expand(positions[c]);
+                    }
+                }
+
+                if (castsShadows) {
+                    for (size_t c = 0; c + 2 < cornerCount; c += 3) {
+                        RayTracer::Triangle triangle;
+                        for (int k = 0; k < 3; k++) {
+                            triangle.positions[k] = positions[c + k];
+                            float length = glm::length(normals[c + k]);
+                            triangle.normals[k] = length > 1e-8f ? normals[c + k] / length : normals[c + k];
+                        }
+                        triangle.material = inserted.first->second;
+                        tracer.addTriangle(triangle);
+                    }
+                }
+                if (lightmapped) {
+                    staticMeshes.push_back(StaticMesh{ i, atlas.addMesh(std::move(positions), std::move(normals)) });
+                    staticMeshCounts[i]++;
+                }
+            }
+        }
+
+        materialAlbedo.resize(texturePaths.size());
+        jobs.parallelFor(texturePaths.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                materialAlbedo[i] = averageColour(texturePaths[i]);
+            }
+        });
+    }
+
+    glm::vec3 ambient() const {
+        glm::vec3 sum(0.0f);
+        for (const Light& light : scene.lights) {
+            sum += light.ambient;
+        }
+        return sum;
+    }
+
+    // Attenuated Lambert lighting from every light that is not shadowed.
+    glm::vec3 directLight(const glm::vec3& position, const glm::vec3& normal) const {
+        glm::vec3 result(0.0f);
+        glm::vec3 origin = position + normal * SURFACE_BIAS;
+        for (const Light& light : scene.lights) {
+            glm::vec3 toLight = light.position - origin;
+            float distance = glm::length(toLight);
+            if (distance < 1e-6f) continue;
+            glm::vec3 direction = toLight / distance;
+            float diffuse = glm::dot(normal, direction);
+            if (diffuse <= 0.0f) continue;
+            if (distance > SHADOW_NEAR && tracer.occluded(origin, direction, distance - SHADOW_NEAR)) continue;
+
+            float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+            result += light.diffuse * diffuse * attenuation;
+        }
+        return result;
+    }
+
+    static glm::vec3 cosineDirection(const glm::vec3& normal, Random& random) {
+        float u1 = random.next();
+        float u2 = random.next();
+        float r = std::sqrt(u1);
+        float phi = 6.28318530718f * u2;
+        glm::vec3 axis = std::fabs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 tangent = glm::normalize(glm::cross(axis, normal));
+        glm::vec3 bitangent = glm::cross(normal, tangent);
+        return glm::normalize(tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + normal * std::sqrt(1.0f - u1));
+    }
+
+    // Light reflected towards origin along one cosine weighted path of up to bounces
+    // diffuse hits; firstHit tells what the first ray ran into.
+    glm::vec3 tracePath(glm::vec3 origin, glm::vec3 direction, int bounces, Random& random, FirstHit& firstHit) const {
+        glm::vec3 result(0.0f);
+        glm::vec3 throughput(1.0f);
+        firstHit = FirstHit::Miss;
+        for (int bounce = 0; bounce < bounces; bounce++) {
+            RayTracer::Hit hit;
+            if (!tracer.intersect(origin, direction, 1e30f, hit)) break;
+
+            glm::vec3 normal = tracer.getNormal(hit);
+            bool backface = glm::dot(normal, direction) > 0.0f;
+            if (bounce == 0) {
+                firstHit = backface ? FirstHit::Back : FirstHit::Front;
+            }
+            if (backface) break;
+            glm::vec3 position = origin + direction * hit.distance;
+            throughput *= materialAlbedo[tracer.getTriangle(hit.triangle).material];
+            result += throughput * directLight(position, normal);
+
+            origin = position + normal * SURFACE_BIAS;
+            direction = cosineDirection(normal, random);
+        }
+        return result;
+    }
+
+    void bakeLightmap(BakedLighting& baked) {
+        int size = atlas.getSize();
+        const std::vector<LightmapAtlas::Texel>& texels = atlas.getTexels();
+        glm::vec3 ambientLight = ambient();
+
+        baked.atlasWidth = size;
+        baked.atlasHeight = size;
+        baked.atlas.assign(static_cast<size_t>(size) * size * 3, 0.0f);
+        jobs.parallelFor(static_cast<size_t>(size), 4, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++) {
+                for (size_t x = 0; x < static_cast<size_t>(size); x++) {
+                    size_t index = y * size + x;
+                    const LightmapAtlas::Texel& texel = texels[index];
+                    if (!texel.covered) continue;
+
+                    glm::vec3 light = ambientLight + directLight(texel.position, texel.normal);
+                    if (settings.bounces > 0) {
+                        Random random(index);
+                        glm::vec3 indirect(0.0f);
+                        glm::vec3 origin = texel.position + texel.normal * SURFACE_BIAS;
+                        for (int s = 0; s < settings.samples; s++) {
+                            FirstHit firstHit;
+                            indirect += tracePath(origin, cosineDirection(texel.normal, random), settings.bounces, random, firstHit);
+                        }
+                        light += indirect / static_cast<float>(settings.samples);
+                    }
+                    baked.atlas[index * 3] = light.x;
+                    baked.atlas[index * 3 + 1] = light.y;
+                    baked.atlas[index * 3 + 2] = light.z;
+                }
+            }
+        });
+        atlas.dilate(baked.atlas, DILATION_PASSES);
+    }
+
+    void bakeProbes(BakedLighting& baked) {
+        static const glm::vec3 FACES[6] = {
+            { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+            { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+        };
+
+        AABB bounds = staticBounds.isValid() ? staticBounds : tracer.getBounds();
+        if (!bounds.isValid()) return;
+
+        baked.probeSpacing = settings.probeSpacing;
+        baked.probeOrigin = bounds.min;
+        baked.probeCounts = glm::ivec3(glm::floor((bounds.max - bounds.min) / settings.probeSpacing)) + glm::ivec3(1);
+        size_t count = static_cast<size_t>(baked.probeCounts.x) * baked.probeCounts.y * baked.probeCounts.z;
+        baked.probes.assign(count, BakedLighting::AmbientCube());
+        baked.probeValid.assign(count, 1);
+
+        int bounces = std::max(1, settings.bounces);
+        jobs.parallelFor(count, 8, [&](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; index++) {
+                glm::ivec3 cell(static_cast<int>(index % baked.probeCounts.x),
+                    static_cast<int>(index / baked.probeCounts.x % baked.probeCounts.y),
+                    static_cast<int>(index / (static_cast<size_t>(baked.probeCounts.x) * baked.probeCounts.y)));
+                glm::vec3 position = baked.probeOrigin + glm::vec3(cell) * settings.probeSpacing;
+
+                Random random(index + 0x9e3779b97f4a7c15ull);
+                int hits = 0, backfaces = 0;
+                for (int face = 0; face < 6; face++) {
+                    glm::vec3 sum(0.0f);
+                    for (int s = 0; s < settings.samples; s++) {
+                        FirstHit firstHit;
+                        sum += tracePath(position, cosineDirection(FACES[face], random), bounces, random, firstHit);
+                        hits += firstHit != FirstHit::Miss;
+                        backfaces += firstHit == FirstHit::Back;
+                    }
+                    baked.probes[index].faces[face] = sum / static_cast<float>(settings.samples);
+                }
+                // Probes inside walls or exhibits see back faces, probes outside the
+                // building see mostly sky; either would only darken their neighbours.
+                int rays = 6 * settings.samples;
+                baked.probeValid[index] = hits >= (1.0f - MISS_LIMIT) * rays && backfaces <= BACKFACE_LIMIT * hits;
+            }
+        });
+    }
+
+public:
+    LightingBaker(JobSystem& jobs, const SceneDescription& scene, const BakeSettings& settings)
+        : jobs(jobs), scene(scene), settings(settings) {
+    }
+
+    BakedLighting bake(uint64_t sceneHash) {
+        using Clock = std::chrono::steady_clock;
+        auto seconds = [](Clock::time_point since) {
+            return std::chrono::duration<double>(Clock::now() - since).count();
+        };
+
+        auto start = Clock::now();
+        loadGeometry();
+        tracer.build();
+        std::cout << "Geometry: " << tracer.getTriangleCount() << " shadow casting triangles, "
+            << tracer.getNodeCount() << " BVH nodes, " << materialAlbedo.size() << " materials ("
+            << seconds(start) << " s)\n";
+        if (staticMeshes.empty()) {
+            throw std::runtime_error("The scene has no static models to lightmap");
+        }
+
+        start = Clock::now();
+        float density = settings.texelsPerUnit;
+        while (!atlas.build(density, settings.maxAtlasSize)) {
+            density *= 0.8f;
+            if (density < 0.5f) {
+                throw std::runtime_error("Static geometry does not fit into the lightmap atlas");
+            }
+            std::cout << "Atlas too small, lowering the density to " << density << " texels per unit\n";
+        }
+        atlas.rasterize(jobs);
+        std::cout << "Atlas: " << atlas.getSize() << "x" << atlas.getSize() << ", " << atlas.getChartCount()
+            << " charts (" << seconds(start) << " s)\n";
+
+        BakedLighting baked;
+        baked.sceneHash = sceneHash;
+
+        start = Clock::now();
+        bakeLightmap(baked);
+        std::cout << "Lightmap: " << settings.bounces << " bounces, " << settings.samples << " samples ("
+            << seconds(start) << " s)\n";
+
+        start = Clock::now();
+        bakeProbes(baked);
+        size_t valid = static_cast<size_t>(std::count(baked.probeValid.begin(), baked.probeValid.end(), 1));
+        std::cout << "Probes: " << baked.probes.size() << " (" << valid << " valid, " << seconds(start) << " s)\n";
+
+        size_t next = 0;
+        for (size_t i = 0; i < scene.models.size(); i++) {
+            if (staticMeshCounts[i] == 0) continue;
+            BakedLighting::ModelLightmap model;
+            model.modelIndex = static_cast<uint32_t>(i);
+            model.objPath = scene.models[i].objPath;
+            for (size_t m = 0; m < staticMeshCounts[i]; m++) {
+                model.meshCoords.push_back(std::move(atlas.getCoords(staticMeshes[next++].atlasMesh)));
+            }
+            baked.models.push_back(std::move(model));
+        }
+        return baked;
+    }
+};
\ No newline at end of file
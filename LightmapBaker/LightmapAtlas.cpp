@@ -0,0 +1 @@
+#include "LightmapAtlas.h"
\ No newline at end of file
@@ -0,0 +1,387 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.h"
+
+// Unique lightmap coordinates for static geometry. Triangles are grouped into nearly
+// planar charts, each chart is projected onto its plane at a fixed texel density and
+// the charts are shelf packed into one square atlas. rasterize() then records the
+// world position and normal behind every texel, which is what the baker lights.
+class LightmapAtlas {
+public:
+    struct Texel {
+        glm::vec3 position{ 0.0f };
+        glm::vec3 normal{ 0.0f };
+        float distance = 1e30f;     // 0 when the texel centre is inside a triangle
+        bool covered = false;
+    };
+
+private:
+    // Charts are kept this many texels apart so bilinear filtering and dilation never
+    // mix two charts.
+    static const int PADDING = 2;
+    const float CHART_NORMAL_THRESHOLD = 0.9f;
+
+    struct MeshInput {
+        std::vector<glm::vec3> positions;   // world space, three per triangle
+        std::vector<glm::vec3> normals;
+        std::vector<float> coords;          // result, two per corner
+    };
+
+    struct Chart {
+        size_t mesh;
+        std::vector<size_t> triangles;
+        glm::vec3 tangent, bitangent;
+        glm::vec2 minimum;                  // in texels, before placement
+        int width = 0, height = 0;
+        int x = 0, y = 0;                   // placement in the atlas
+    };
+
+    std::vector<MeshInput> meshes;
+    std::vector<Chart> charts;
+    std::vector<Texel> texels;
+    int size = 0;
+
+    static glm::vec3 faceNormal(const glm::vec3* corners) {
+        glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        float length = glm::length(normal);
+        return length > 1e-12f ? normal / length : glm::vec3(0.0f);
+    }
+
+    struct PositionKey {
+        int64_t x, y, z;
+        bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct PositionKeyHash {
+        size_t operator()(const PositionKey& key) const {
+            return static_cast<size_t>(key.x * 73856093ll ^ key.y * 19349663ll ^ key.z * 83492791ll);
+        }
+    };
+
+    // Flood fills triangles sharing an edge whose normals stay close to the seed's.
+    void buildCharts(size_t meshIndex) {
+        const MeshInput& mesh = meshes[meshIndex];
+        size_t triangleCount = mesh.positions.size() / 3;
+
+        // Corners are not shared, so weld them by position to find the edges.
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> welded;
+        std::vector<uint32_t> vertexIds(mesh.positions.size());
+        for (size_t i = 0; i < mesh.positions.size(); i++) {
+            glm::vec3 p = mesh.positions[i] * 10000.0f;
+            PositionKey key{ std::llround(p.x), std::llround(p.y), std::llround(p.z) };
+            auto inserted = welded.emplace(key, static_cast<uint32_t>(welded.size()));
+            vertexIds[i] = inserted.first->second;
+        }
+
+        std::unordered_map<uint64_t, std::vector<uint32_t>> edgeTriangles;
+        auto edgeKey = [](uint32_t a, uint32_t b) {
+            return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        };
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int e = 0; e < 3; e++) {
+                edgeTriangles[edgeKey(vertexIds[t * 3 + e], vertexIds[t * 3 + (e + 1) % 3])].push_back(static_cast<uint32_t>(t));
+            }
+        }
+
+        std::vector<glm::vec3> normals(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            normals[t] = faceNormal(&mesh.positions[t * 3]);
+        }
+
+        std::vector<char> assigned(triangleCount, 0);
+        std::vector<size_t> queue;
+        for (size_t seed = 0; seed < triangleCount; seed++) {
+            if (assigned[seed] || normals[seed] == glm::vec3(0.0f)) continue;
+
+            Chart chart;
+            chart.mesh = meshIndex;
+            glm::vec3 chartNormal = normals[seed];
+            assigned[seed] = 1;
+            queue.assign(1, seed);
+            while (!queue.empty()) {
+                size_t t = queue.back();
+                queue.pop_back();
+                chart.triangles.push_back(t);
+                for (int e = 0; e < 3; e++) {
+                    for (uint32_t neighbour : edgeTriangles[edgeKey(vertexIds[t * 3 + e], vertexIds[t * 3 + (e + 1) % 3])]) {
+                        if (!assigned[neighbour] && glm::dot(normals[neighbour], chartNormal) > CHART_NORMAL_THRESHOLD) {
+                            assigned[neighbour] = 1;
+                            queue.push_back(neighbour);
+                        }
+                    }
+                }
+            }
+
+            glm::vec3 axis = std::fabs(chartNormal.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            chart.tangent = glm::normalize(glm::cross(axis, chartNormal));
+            chart.bitangent = glm::cross(chartNormal, chart.tangent);
+            alignChart(chart);
+            charts.push_back(std::move(chart));
+        }
+    }
+
+    // Rotates the projection axes so the chart's bounding rectangle is as small as
+    // possible; the best rectangle has a side along one of the chart's edges.
+    void alignChart(Chart& chart) const {
+        const MeshInput& mesh = meshes[chart.mesh];
+        std::vector<glm::vec2> points;
+        std::vector<std::pair<float, glm::vec2>> edges;
+        for (size_t t : chart.triangles) {
+            for (int c = 0; c < 3; c++) {
+                points.push_back(project(chart, mesh.positions[t * 3 + c], 1.0f));
+            }
+            for (int c = 0; c < 3; c++) {
+                glm::vec2 edge = points[points.size() - 3 + (c + 1) % 3] - points[points.size() - 3 + c];
+                float length = glm::length(edge);
+                if (length > 1e-6f) edges.emplace_back(length, edge / length);
+            }
+        }
+        // The longest edges are the likely candidates; this keeps big charts cheap.
+        const size_t MAX_CANDIDATES = 64;
+        if (edges.size() > MAX_CANDIDATES) {
+            std::partial_sort(edges.begin(), edges.begin() + MAX_CANDIDATES, edges.end(),
+                [](const std::pair<float, glm::vec2>& a, const std::pair<float, glm::vec2>& b) { return a.first > b.first; });
+            edges.resize(MAX_CANDIDATES);
+        }
+
+        glm::vec2 best(1.0f, 0.0f);
+        float bestArea = 1e30f;
+        for (const auto& edge : edges) {
+            glm::vec2 u = edge.second;
+            glm::vec2 v(-u.y, u.x);
+            glm::vec2 minimum(1e30f), maximum(-1e30f);
+            for (const glm::vec2& point : points) {
+                glm::vec2 rotated(glm::dot(point, u), glm::dot(point, v));
+                minimum = glm::min(minimum, rotated);
+                maximum = glm::max(maximum, rotated);
+            }
+            float area = (maximum.x - minimum.x) * (maximum.y - minimum.y);
+            if (area < bestArea * 0.999f) {
+                bestArea = area;
+                best = u;
+            }
+        }
+
+        glm::vec3 tangent = chart.tangent * best.x + chart.bitangent * best.y;
+        glm::vec3 bitangent = chart.bitangent * best.x - chart.tangent * best.y;
+        chart.tangent = tangent;
+        chart.bitangent = bitangent;
+    }
+
+    glm::vec2 project(const Chart& chart, const glm::vec3& position, float texelsPerUnit) const {
+        return glm::vec2(glm::dot(position, chart.tangent), glm::dot(position, chart.bitangent)) * texelsPerUnit;
+    }
+
+    // Shelf packing into a square of atlasSize; false if the charts do not fit.
+    bool pack(int atlasSize) {
+        std::vector<size_t> order(charts.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return charts[a].height > charts[b].height;
+        });
+
+        int x = 0, y = 0, shelfHeight = 0;
+        for (size_t index : order) {
+            Chart& chart = charts[index];
+            if (chart.width > atlasSize) return false;
+            if (x + chart.width > atlasSize) {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (y + chart.height > atlasSize) return false;
+            chart.x = x;
+            chart.y = y;
+            x += chart.width;
+            shelfHeight = std::max(shelfHeight, chart.height);
+        }
+        return true;
+    }
+
+    // Closest point of triangle abc to p, as barycentrics, and its distance.
+    static glm::vec3 closestBarycentric(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c,
+        float& distance) {
+        glm::vec2 v0 = b - a, v1 = c - a, v2 = p - a;
+        float d00 = glm::dot(v0, v0), d01 = glm::dot(v0, v1), d11 = glm::dot(v1, v1);
+        float d20 = glm::dot(v2, v0), d21 = glm::dot(v2, v1);
+        float denominator = d00 * d11 - d01 * d01;
+        if (std::fabs(denominator) > 1e-12f) {
+            float v = (d11 * d20 - d01 * d21) / denominator;
+            float w = (d00 * d21 - d01 * d20) / denominator;
+            if (v >= 0.0f && w >= 0.0f && v + w <= 1.0f) {
+                distance = 0.0f;
+                return glm::vec3(1.0f - v - w, v, w);
+            }
+        }
+
+        // Outside: nearest point on the three edges.
+        glm::vec3 best(1.0f, 0.0f, 0.0f);
+        distance = 1e30f;
+        const glm::vec2 corners[3] = { a, b, c };
+        for (int e = 0; e < 3; e++) {
+            glm::vec2 from = corners[e];
+            glm::vec2 edge = corners[(e + 1) % 3] - from;
+            float length = glm::dot(edge, edge);
+            float t = length > 0.0f ? glm::clamp(glm::dot(p - from, edge) / length, 0.0f, 1.0f) : 0.0f;
+            float d = glm::length(p - (from + edge * t));
+            if (d < distance) {
+                distance = d;
+                best = glm::vec3(0.0f);
+                best[e] = 1.0f - t;
+                best[(e + 1) % 3] = t;
+            }
+        }
+        return best;
+    }
+
+public:
+    // positions and normals are world space corners, three per triangle. Returns the
+    // index used with getCoords().
+    size_t addMesh(std::vector<glm::vec3> positions, std::vector<glm::vec3> normals) {
+        MeshInput mesh;
+        mesh.positions = std::move(positions);
+        mesh.normals = std::move(normals);
+        meshes.push_back(std::move(mesh));
+        return meshes.size() - 1;
+    }
+
+    // Charts and packs everything added so far. Returns false if the charts do not
+    // fit into maxSize at this density.
+    bool build(float texelsPerUnit, int maxSize) {
+        charts.clear();
+        for (size_t m = 0; m < meshes.size(); m++) {
+            buildCharts(m);
+        }
+
+        for (Chart& chart : charts) {
+            const MeshInput& mesh = meshes[chart.mesh];
+            glm::vec2 minimum(1e30f), maximum(-1e30f);
+            for (size_t t : chart.triangles) {
+                for (int c = 0; c < 3; c++) {
+                    glm::vec2 p = project(chart, mesh.positions[t * 3 + c], texelsPerUnit);
+                    minimum = glm::min(minimum, p);
+                    maximum = glm::max(maximum, p);
+                }
+            }
+            chart.minimum = minimum;
+            chart.width = static_cast<int>(std::ceil(maximum.x - minimum.x)) + 1 + 2 * PADDING;
+            chart.height = static_cast<int>(std::ceil(maximum.y - minimum.y)) + 1 + 2 * PADDING;
+        }
+
+        size = 0;
+        for (int atlasSize = 64; atlasSize <= maxSize; atlasSize *= 2) {
+            if (pack(atlasSize)) {
+                size = atlasSize;
+                break;
+            }
+        }
+        if (size == 0) return false;
+
+        for (MeshInput& mesh : meshes) {
+            mesh.coords.assign(mesh.positions.size() * 2, 0.0f);
+        }
+        for (const Chart& chart : charts) {
+            MeshInput& mesh = meshes[chart.mesh];
+            glm::vec2 offset = glm::vec2(chart.x + PADDING, chart.y + PADDING) - chart.minimum + glm::vec2(0.5f);
+            for (size_t t : chart.triangles) {
+                for (int c = 0; c < 3; c++) {
+                    glm::vec2 texel = project(chart, mesh.positions[t * 3 + c], texelsPerUnit) + offset;
+                    mesh.coords[(t * 3 + c) * 2] = texel.x / size;
+                    mesh.coords[(t * 3 + c) * 2 + 1] = texel.y / size;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Finds the surface behind every texel. Texels whose centre lies just outside a
+    // triangle take the nearest point on it, so filtering at chart borders stays valid.
+    void rasterize(JobSystem& jobs) {
+        texels.assign(static_cast<size_t>(size) * size, Texel());
+        jobs.parallelFor(charts.size(), 1, [this](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; index++) {
+                const Chart& chart = charts[index];
+                const MeshInput& mesh = meshes[chart.mesh];
+                for (size_t t : chart.triangles) {
+                    glm::vec2 uv[3];
+                    for (int c = 0; c < 3; c++) {
+                        uv[c] = glm::vec2(mesh.coords[(t * 3 + c) * 2], mesh.coords[(t * 3 + c) * 2 + 1]) * static_cast<float>(size);
+                    }
+                    glm::vec2 low = glm::min(uv[0], glm::min(uv[1], uv[2]));
+                    glm::vec2 high = glm::max(uv[0], glm::max(uv[1], uv[2]));
+                    int x0 = std::max(chart.x, static_cast<int>(std::floor(low.x)) - 1);
+                    int y0 = std::max(chart.y, static_cast<int>(std::floor(low.y)) - 1);
+                    int x1 = std::min(chart.x + chart.width - 1, static_cast<int>(std::ceil(high.x)) + 1);
+                    int y1 = std::min(chart.y + chart.height - 1, static_cast<int>(std::ceil(high.y)) + 1);
+
+                    for (int y = y0; y <= y1; y++) {
+                        for (int x = x0; x <= x1; x++) {
+                            float distance;
+                            glm::vec3 weights = closestBarycentric(glm::vec2(x + 0.5f, y + 0.5f), uv[0], uv[1], uv[2], distance);
+                            Texel& texel = texels[static_cast<size_t>(y) * size + x];
+                            if (distance > 0.75f || distance >= texel.distance) continue;
+
+                            texel.position = mesh.positions[t * 3] * weights.x + mesh.positions[t * 3 + 1] * weights.y +
+                                mesh.positions[t * 3 + 2] * weights.z;
+                            glm::vec3 normal = mesh.normals[t * 3] * weights.x + mesh.normals[t * 3 + 1] * weights.y +
+                                mesh.normals[t * 3 + 2] * weights.z;
+                            float length = glm::length(normal);
+                            texel.normal = length > 1e-8f ? normal / length : faceNormal(&mesh.positions[t * 3]);
+                            texel.distance = distance;
+                            texel.covered = true;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // Grows covered texels into their empty neighbours, passes texels at a time.
+    void dilate(std::vector<float>& rgb, int passes) const {
+        std::vector<char> filled(texels.size());
+        for (size_t i = 0; i < texels.size(); i++) {
+            filled[i] = texels[i].covered;
+        }
+
+        for (int pass = 0; pass < passes; pass++) {
+            std::vector<char> next = filled;
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    size_t index = static_cast<size_t>(y) * size + x;
+                    if (filled[index]) continue;
+
+                    glm::vec3 sum(0.0f);
+                    int count = 0;
+                    for (int dy = -1; dy <= 1; dy++) {
+                        for (int dx = -1; dx <= 1; dx++) {
+                            int nx = x + dx, ny = y + dy;
+                            if (nx < 0 || ny < 0 || nx >= size || ny >= size) continue;
+                            size_t neighbour = static_cast<size_t>(ny) * size + nx;
+                            if (!filled[neighbour]) continue;
+                            sum += glm::vec3(rgb[neighbour * 3], rgb[neighbour * 3 + 1], rgb[neighbour * 3 + 2]);
+                            count++;
+                        }
+                    }
+                    if (count > 0) {
+                        sum /= static_cast<float>(count);
+                        rgb[index * 3] = sum.x;
+                        rgb[index * 3 + 1] = sum.y;
+                        rgb[index * 3 + 2] = sum.z;
+                        next[index] = 1;
+                    }
+                }
+            }
+            filled.swap(next);
+        }
+    }
+
+    int getSize() const { return size; }
+    size_t getChartCount() const { return charts.size(); }
+    const std::vector<Texel>& getTexels() const { return texels; }
+    std::vector<float>& getCoords(size_t mesh) { return meshes[mesh].coords; }
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "BakedLighting.h"
+#include "JobSystem.h"
+#include "LightingBaker.h"
+#include "SceneDescription.h"
+
+// Headless: no window or GL context, so it also runs on build machines. Run it from
+// a directory next to Models/ (like Muzeu3D/) so the paths in the scene file resolve.
+static void printUsage() {
+    std::cout << "Usage: LightmapBaker [scene] [options]\n"
+        "  scene                      defaults to ../Scenes/muzeu.scene\n"
+        "  --output <path>            defaults to the scene's baked path\n"
+        "  --texels-per-unit <n>      lightmap density (16)\n"
+        "  --max-atlas <n>            largest atlas size in texels (4096)\n"
+        "  --bounces <n>              indirect bounces, 0 for direct light only (0)\n"
+        "  --samples <n>              rays per texel and probe face (64)\n"
+        "  --probe-spacing <units>    distance between irradiance probes (1)\n"
+        "  --threads <n>              worker threads, 0 for one per core (0)\n";
+}
+
+int main(int argc, char** argv) {
+    std::string scenePath = "../Scenes/muzeu.scene";
+    std::string outputPath;
+    BakeSettings settings;
+    unsigned int threads = 0;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("Missing value for " + argument);
+                }
+                return argv[++i];
+            };
+
+            if (argument == "--help" || argument == "-h") {
+                printUsage();
+                return 0;
+            }
+            else if (argument == "--output") outputPath = value();
+            else if (argument == "--texels-per-unit") settings.texelsPerUnit = std::stof(value());
+            else if (argument == "--max-atlas") settings.maxAtlasSize = std::stoi(value());
+            else if (argument == "--bounces") settings.bounces = std::stoi(value());
+            else if (argument == "--samples") settings.samples = std::stoi(value());
+            else if (argument == "--probe-spacing") settings.probeSpacing = std::stof(value());
+            else if (argument == "--threads") threads = static_cast<unsigned int>(std::stoul(value()));
+            else if (!argument.empty() && argument[0] == '-') throw std::runtime_error("Unknown option " + argument);
+            else scenePath = argument;
+        }
+        if (settings.texelsPerUnit <= 0.0f || settings.samples < 1 || settings.bounces < 0 || settings.probeSpacing <= 0.0f) {
+            throw std::runtime_error("Invalid bake settings");
+        }
+
+        SceneDescription scene = SceneDescription::load(scenePath);
+        if (outputPath.empty()) {
+            outputPath = scene.bakedLightingPath;
+        }
+        if (outputPath.empty()) {
+            throw std::runtime_error(scenePath + " has no baked path, pass --output");
+        }
+
+        JobSystem jobs(threads);
+        std::cout << "Baking " << scenePath << " with " << jobs.getWorkerCount() + 1 << " threads\n";
+        LightingBaker baker(jobs, scene, settings);
+        BakedLighting baked = baker.bake(BakedLighting::hashFile(scenePath));
+        baked.save(outputPath);
+        std::cout << "Wrote " << outputPath << "\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1 @@
+#include "RayTracer.h"
\ No newline at end of file
@@ -0,0 +1,265 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Bounds.h"
+
+// Triangle soup in world space with a bounding volume hierarchy built by binned SAH.
+// Read only once built, so any number of threads can trace against it.
+class RayTracer {
+public:
+    struct Triangle {
+        glm::vec3 positions[3];
+        glm::vec3 normals[3];
+        int material;
+    };
+
+    struct Hit {
+        float distance;
+        uint32_t triangle;
+        float u, v;             // barycentrics of the second and third vertex
+    };
+
+private:
+    struct Node {
+        AABB bounds;
+        uint32_t first;         // first triangle of a leaf, left child otherwise
+        uint32_t count;         // 0 for inner nodes; the right child follows the left one
+    };
+
+    static const uint32_t MAX_LEAF_SIZE = 4;
+    static const int BIN_COUNT = 12;
+
+    std::vector<Triangle> triangles;
+    std::vector<glm::vec3> centroids;
+    std::vector<Node> nodes;
+
+    AABB triangleBounds(uint32_t index) const {
+        AABB bounds;
+        for (const auto& position : triangles[index].positions) {
+            bounds.expand(position);
+        }
+        return bounds;
+    }
+
+    void updateBounds(Node& node) const {
+        node.bounds = AABB();
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            node.bounds = AABB::merge(node.bounds, triangleBounds(i));
+        }
+    }
+
+    void subdivide(uint32_t nodeIndex) {
+        std::vector<uint32_t> stack{ nodeIndex };
+        while (!stack.empty()) {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            Node node = nodes[index];
+            if (node.count <= MAX_LEAF_SIZE) continue;
+
+            AABB centroidBounds;
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                centroidBounds.expand(centroids[i]);
+            }
+
+            // Cheapest split over BIN_COUNT buckets on every axis.
+            int bestAxis = -1;
+            int bestSplit = 0;
+            float bestCost = node.bounds.getSurfaceArea() * node.count;
+            for (int axis = 0; axis < 3; axis++) {
+                float minimum = centroidBounds.min[axis];
+                float extent = centroidBounds.max[axis] - minimum;
+                if (extent <= 0.0f) continue;
+
+                AABB binBounds[BIN_COUNT];
+                uint32_t binCounts[BIN_COUNT] = {};
+                float scale = BIN_COUNT / extent;
+                for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                    int bin = std::min(BIN_COUNT - 1, static_cast<int>((centroids[i][axis] - minimum) * scale));
+                    binCounts[bin]++;
+                    binBounds[bin] = AABB::merge(binBounds[bin], triangleBounds(i));
+                }
+
+                float leftArea[BIN_COUNT - 1], rightArea[BIN_COUNT - 1];
+                uint32_t leftCount[BIN_COUNT - 1], rightCount[BIN_COUNT - 1];
+                AABB left, right;
+                uint32_t leftSum = 0, rightSum = 0;
+                for (int i = 0; i < BIN_COUNT - 1; i++) {
+                    leftSum += binCounts[i];
+                    leftCount[i] = leftSum;
+                    if (binCounts[i]) left = AABB::merge(left, binBounds[i]);
+                    leftArea[i] = left.isValid() ? left.getSurfaceArea() : 0.0f;
+
+                    rightSum += binCounts[BIN_COUNT - 1 - i];
+                    rightCount[BIN_COUNT - 2 - i] = rightSum;
+                    if (binCounts[BIN_COUNT - 1 - i]) right = AABB::merge(right, binBounds[BIN_COUNT - 1 - i]);
+                    rightArea[BIN_COUNT - 2 - i] = right.isValid() ? right.getSurfaceArea() : 0.0f;
+                }
+                for (int i = 0; i < BIN_COUNT - 1; i++) {
+                    float cost = leftArea[i] * leftCount[i] + rightArea[i] * rightCount[i];
+                    if (leftCount[i] && rightCount[i] && cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+            if (bestAxis < 0) continue;
+
+            float minimum = centroidBounds.min[bestAxis];
+            float scale = BIN_COUNT / (centroidBounds.max[bestAxis] - minimum);
+            uint32_t i = node.first;
+            uint32_t j = node.first + node.count;
+            while (i < j) {
+                int bin = std::min(BIN_COUNT - 1, static_cast<int>((centroids[i][bestAxis] - minimum) * scale));
+                if (bin <= bestSplit) {
+                    i++;
+                }
+                else {
+                    j--;
+                    std::swap(triangles[i], triangles[j]);
+                    std::swap(centroids[i], centroids[j]);
+                }
+            }
+
+            uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+            Node left{ AABB(), node.first, i - node.first };
+            Node right{ AABB(), i, node.first + node.count - i };
+            updateBounds(left);
+            updateBounds(right);
+            nodes.push_back(left);
+            nodes.push_back(right);
+            nodes[index].first = leftIndex;
+            nodes[index].count = 0;
+            stack.push_back(leftIndex);
+            stack.push_back(leftIndex + 1);
+        }
+    }
+
+    static bool intersectBounds(const AABB& bounds, const glm::vec3& origin, const glm::vec3& inverseDirection,
+        float maxDistance, float& entry) {
+        glm::vec3 t0 = (bounds.min - origin) * inverseDirection;
+        glm::vec3 t1 = (bounds.max - origin) * inverseDirection;
+        glm::vec3 nearest = glm::min(t0, t1);
+        glm::vec3 farthest = glm::max(t0, t1);
+        entry = std::max(std::max(nearest.x, nearest.y), std::max(nearest.z, 0.0f));
+        float exit = std::min(std::min(farthest.x, farthest.y), std::min(farthest.z, maxDistance));
+        return entry <= exit;
+    }
+
+    // Moller-Trumbore, double sided.
+    static bool intersectTriangle(const Triangle& triangle, const glm::vec3& origin, const glm::vec3& direction,
+        float& distance, float& u, float& v) {
+        glm::vec3 edge1 = triangle.positions[1] - triangle.positions[0];
+        glm::vec3 edge2 = triangle.positions[2] - triangle.positions[0];
+        glm::vec3 p = glm::cross(direction, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (std::fabs(determinant) < 1e-12f) return false;
+
+        float inverse = 1.0f / determinant;
+        glm::vec3 s = origin - triangle.positions[0];
+        u = glm::dot(s, p) * inverse;
+        if (u < 0.0f || u > 1.0f) return false;
+        glm::vec3 q = glm::cross(s, edge1);
+        v = glm::dot(direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f) return false;
+        distance = glm::dot(edge2, q) * inverse;
+        return distance > 0.0f;
+    }
+
+    // anyHit stops at the first intersection, otherwise hit is the closest one.
+    bool trace(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool anyHit, Hit& hit) const {
+        if (nodes.empty()) return false;
+
+        glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        bool found = false;
+        hit.distance = maxDistance;
+
+        uint32_t stack[128];
+        int top = 0;
+        float entry;
+        if (!intersectBounds(nodes[0].bounds, origin, inverseDirection, maxDistance, entry)) return false;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (node.count > 0) {
+                for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                    float distance, u, v;
+                    if (intersectTriangle(triangles[i], origin, direction, distance, u, v) && distance < hit.distance) {
+                        hit.distance = distance;
+                        hit.triangle = i;
+                        hit.u = u;
+                        hit.v = v;
+                        found = true;
+                        if (anyHit) return true;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first.
+            float leftEntry, rightEntry;
+            bool left = intersectBounds(nodes[node.first].bounds, origin, inverseDirection, hit.distance, leftEntry);
+            bool right = intersectBounds(nodes[node.first + 1].bounds, origin, inverseDirection, hit.distance, rightEntry);
+            if (left && right) {
+                bool leftFirst = leftEntry <= rightEntry;
+                stack[top++] = leftFirst ? node.first + 1 : node.first;
+                stack[top++] = leftFirst ? node.first : node.first + 1;
+            }
+            else if (left) {
+                stack[top++] = node.first;
+            }
+            else if (right) {
+                stack[top++] = node.first + 1;
+            }
+        }
+        return found;
+    }
+
+public:
+    void addTriangle(const Triangle& triangle) {
+        triangles.push_back(triangle);
+    }
+
+    void build() {
+        centroids.resize(triangles.size());
+        for (size_t i = 0; i < triangles.size(); i++) {
+            centroids[i] = (triangles[i].positions[0] + triangles[i].positions[1] + triangles[i].positions[2]) / 3.0f;
+        }
+        nodes.clear();
+        if (triangles.empty()) return;
+
+        nodes.reserve(triangles.size() * 2);
+        Node root{ AABB(), 0, static_cast<uint32_t>(triangles.size()) };
+        updateBounds(root);
+        nodes.push_back(root);
+        subdivide(0);
+    }
+
+    bool intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const {
+        return trace(origin, direction, maxDistance, false, hit);
+    }
+
+    bool occluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+        Hit hit;
+        return trace(origin, direction, maxDistance, true, hit);
+    }
+
+    const Triangle& getTriangle(uint32_t index) const { return triangles[index]; }
+    size_t getTriangleCount() const { return triangles.size(); }
+    size_t getNodeCount() const { return nodes.size(); }
+    AABB getBounds() const { return nodes.empty() ? AABB() : nodes[0].bounds; }
+
+    // Interpolated, normalized shading normal at a hit.
+    glm::vec3 getNormal(const Hit& hit) const {
+        const Triangle& triangle = triangles[hit.triangle];
+        glm::vec3 normal = triangle.normals[0] * (1.0f - hit.u - hit.v) + triangle.normals[1] * hit.u + triangle.normals[2] * hit.v;
+        float length = glm::length(normal);
+        if (length > 1e-8f) return normal / length;
+        return glm::normalize(glm::cross(triangle.positions[1] - triangle.positions[0], triangle.positions[2] - triangle.positions[0]));
+    }
+};
\ No newline at end of file
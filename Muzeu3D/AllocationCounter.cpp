@@ -0,0 +1,128 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef MUZEU_ALLOCATION_COUNTER
+
+namespace {
+    thread_local uint64_t allocations = 0;
+    thread_local uint64_t allocatedBytes = 0;
+
+    void* countedAllocate(std::size_t size) {
+        allocations++;
+        allocatedBytes += size;
+        if (size == 0) {
+            size = 1;
+        }
+        while (true) {
+            if (void* memory = std::malloc(size)) {
+                return memory;
+            }
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void* countedAllocateNoThrow(std::size_t size) noexcept {
+        try {
+            return countedAllocate(size);
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+}
+
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocateNoThrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocateNoThrow(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+#ifdef __cpp_aligned_new
+
+namespace {
+    void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+        allocations++;
+        allocatedBytes += size;
+        if (size == 0) {
+            size = 1;
+        }
+        while (true) {
+#ifdef _WIN32
+            void* memory = _aligned_malloc(size, static_cast<std::size_t>(alignment));
+#else
+            // posix_memalign wants at least the alignment of a pointer.
+            std::size_t bytes = static_cast<std::size_t>(alignment);
+            void* memory = nullptr;
+            if (posix_memalign(&memory, bytes < sizeof(void*) ? sizeof(void*) : bytes, size) != 0) {
+                memory = nullptr;
+            }
+#endif
+            if (memory) {
+                return memory;
+            }
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void* countedAllocateAlignedNoThrow(std::size_t size, std::align_val_t alignment) noexcept {
+        try {
+            return countedAllocateAligned(size, alignment);
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+
+    void freeAligned(void* memory) noexcept {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAlignedNoThrow(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAlignedNoThrow(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(memory); }
+
+#endif
+
+bool AllocationCounter::isEnabled() { return true; }
+uint64_t AllocationCounter::threadAllocations() { return allocations; }
+uint64_t AllocationCounter::threadBytes() { return allocatedBytes; }
+
+#else
+
+bool AllocationCounter::isEnabled() { return false; }
+uint64_t AllocationCounter::threadAllocations() { return 0; }
+uint64_t AllocationCounter::threadBytes() { return 0; }
+
+#endif
\ No newline at end of file
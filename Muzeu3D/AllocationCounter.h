@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+// Counts the calls to the global operator new made by the calling thread, so a frame
+// can check that it did not touch the heap. The replacement operators are in
+// AllocationCounter.cpp and are only compiled in with MUZEU_ALLOCATION_COUNTER
+// (Debug builds and the Tests project); otherwise the standard allocator stays in
+// place and the counts are zero. The over-aligned operators are replaced too when
+// the compiler has them (C++17). malloc() calls, such as those made by stb_image or
+// the GL driver, are not counted.
+class AllocationCounter {
+public:
+    static bool isEnabled();
+    static uint64_t threadAllocations();
+    static uint64_t threadBytes();
+};
\ No newline at end of file
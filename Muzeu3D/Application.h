@@ -1,12 +1,29 @@
 ﻿#pragma once
 #include "Scene.h"
+#include "FrameScheduler.h"
+#include "FramePipeline.h"
+#include "RenderThread.h"
+#include "ResourceRegistry.h"
+#include "AllocationCounter.h"
 #include <GLFW/glfw3.h>
 #include <memory>
 
 class Application {
 private:
     GLFWwindow* window;
+    JobSystem jobs;
     std::unique_ptr<Scene> scene;
+    FrameScheduler scheduler;
+    const double STATS_REPORT_INTERVAL = 600.0;
+
+    // With threadedRendering the GL context lives on renderThread and this thread only
+    // records command lists; otherwise lists are executed inline.
+    bool threadedRendering = true;
+    FramePipeline pipeline;
+    std::unique_ptr<RenderThread> renderThread;
+    RenderBackend inlineBackend;
+    RenderCommandList inlineList;
+    uint64_t inlineFrameIndex = 0;
 
     void initWindow() {
         if (!glfwInit()) {
@@ -35,6 +52,14 @@ private:
             throw std::runtime_error("Failed to initialize GLEW");
         }
 
+        // Let the driver compile shader variants on its own threads.
+        if (GLEW_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        }
+        else if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        }
+
         glViewport(0, 0, mode->width, mode->height);
         glEnable(GL_DEPTH_TEST);
 
@@ -58,34 +83,140 @@ private:
         lastY = ypos;
 
         auto app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+        app->scheduler.notifyInput();
         app->scene->getCamera()->processMouse(xoffset, yoffset);
+        app->scene->markDirty(Scene::DIRTY_CAMERA);
+    }
+
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        auto app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+        app->scheduler.notifyInput();
+        if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+            app->scene->setOcclusionCulling(!app->scene->isOcclusionCulling());
+            std::cout << "Occlusion culling " << (app->scene->isOcclusionCulling() ? "on" : "off") << std::endl;
+        }
+        if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+            if (!app->scene->hasBakedLighting()) {
+                std::cout << "No baked lighting loaded" << std::endl;
+                return;
+            }
+            app->scene->setBakedLighting(!app->scene->isBakedLighting());
+            std::cout << "Baked lighting " << (app->scene->isBakedLighting() ? "on" : "off") << std::endl;
+        }
+        if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+            app->scene->setDynamicResolution(!app->scene->isDynamicResolution());
+            std::cout << "Dynamic resolution " << (app->scene->isDynamicResolution() ? "on" : "off") << std::endl;
+        }
+        if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+            ResourceRegistry::global().dump(std::cout);
+        }
+    }
+
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+        auto app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+        app->scheduler.notifyInput();
+        if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+            if (Model* exhibit = app->scene->pickExhibit()) {
+                glm::vec3 center = exhibit->getWorldBounds().getCenter();
+                std::cout << "Exhibit: " << exhibit->getName() << " at ("
+                    << center.x << ", " << center.y << ", " << center.z << ")" << std::endl;
+            }
+        }
+    }
+
+    static void refreshCallback(GLFWwindow* window) {
+        auto app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+        app->scene->markDirty(Scene::DIRTY_ALL);
     }
 
 public:
     Application() {
         initWindow();
-        scene = std::make_unique<Scene>();
+        scene = std::make_unique<Scene>(jobs);
         glfwSetWindowUserPointer(window, this);
         glfwSetCursorPosCallback(window, mouseCallback);
+        glfwSetKeyCallback(window, keyCallback);
+        glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        glfwSetWindowRefreshCallback(window, refreshCallback);
+        scheduler.applyVSync();
+
+        if (threadedRendering) {
+            renderThread = std::make_unique<RenderThread>(window, pipeline);
+            renderThread->start();
+        }
     }
 
     ~Application() {
+        if (renderThread) {
+            renderThread->stop();
+            renderThread.reset();
+            glfwMakeContextCurrent(window);
+        }
+        if (scene) {
+            scene->getStats().print(std::cout);
+            ResourceRegistry::global().dump(std::cout);
+            scene.reset();
+            ResourceRegistry::global().reportLeaks(std::cerr);
+        }
         glfwTerminate();
     }
 
+    void submitFrame(float alpha) {
+        if (renderThread) {
+            RenderCommandList* list = pipeline.beginRecording();
+            if (list) {
+                scene->record(*list, alpha);
+                pipeline.submit(list);
+            }
+        }
+        else {
+            inlineList.reset(inlineFrameIndex++);
+            scene->record(inlineList, alpha);
+            inlineBackend.execute(inlineList);
+            if (inlineList.shouldPresent()) {
+                glfwSwapBuffers(window);
+            }
+        }
+    }
+
     void run() {
+        scheduler.start();
+        double lastStatsReport = glfwGetTime();
         while (!glfwWindowShouldClose(window)) {
             if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
                 glfwSetWindowShouldClose(window, true);
             }
 
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            int steps = scheduler.beginFrame();
+            uint64_t allocationsBefore = AllocationCounter::threadAllocations();
+            scene->setAnimationsPaused(scheduler.isIdle() && scheduler.getSettings().pauseAnimationsWhenIdle);
+            for (int i = 0; i < steps; i++) {
+                scene->update(window, scheduler.getFixedTimeStep());
+            }
+
+            // Nothing changed since the last presented frame: keep it on screen and sleep.
+            bool presented = scene->needsRedraw();
+            if (presented) {
+                submitFrame(scheduler.getAlpha());
+                uint64_t allocations = AllocationCounter::threadAllocations() - allocationsBefore;
+                if (renderThread) {
+                    allocations += renderThread->takeAllocations();
+                }
+                if (AllocationCounter::isEnabled()) {
+                    scene->reportFrameAllocations(allocations);
+                }
+            }
+            else {
+                scene->skipFrame();
+            }
 
-            scene->update(window, 0.016f);
-            scene->render();
+            if (glfwGetTime() - lastStatsReport > STATS_REPORT_INTERVAL) {
+                scene->getStats().print(std::cout);
+                ResourceRegistry::global().dump(std::cout);
+                lastStatsReport = glfwGetTime();
+            }
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            scheduler.endFrame(presented);
         }
     }
-};
+};
\ No newline at end of file
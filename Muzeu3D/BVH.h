@@ -0,0 +1,376 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include "Bounds.h"
+
+// Dynamic AABB tree over scene objects. Leaves store "fat" bounds inflated by a
+// margin, so an object that moves or rotates a little only updates its leaf when it
+// leaves the fat box (moveProxy); otherwise the tree is left untouched. Insertions
+// pick the sibling with the lowest surface-area cost and the tree is kept balanced
+// with AVL-style rotations.
+class BVH {
+public:
+    static const int NULL_NODE = -1;
+
+private:
+    struct Node {
+        AABB box;
+        int parent = NULL_NODE;     // next free node while on the free list
+        int left = NULL_NODE;
+        int right = NULL_NODE;
+        int height = -1;            // -1 = free, 0 = leaf
+        int userData = -1;
+
+        bool isLeaf() const { return left == NULL_NODE; }
+    };
+
+    static const int MAX_STACK = 256;
+
+    std::vector<Node> nodes;
+    int root = NULL_NODE;
+    int freeList = NULL_NODE;
+    int proxyCount = 0;
+    float margin;
+
+    int allocateNode() {
+        if (freeList == NULL_NODE) {
+            nodes.emplace_back();
+            freeList = static_cast<int>(nodes.size()) - 1;
+        }
+        int node = freeList;
+        freeList = nodes[node].parent;
+        nodes[node] = Node();
+        nodes[node].height = 0;
+        return node;
+    }
+
+    void freeNode(int node) {
+        nodes[node].parent = freeList;
+        nodes[node].height = -1;
+        freeList = node;
+    }
+
+    void insertLeaf(int leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // Descend towards the cheapest sibling (surface area heuristic).
+        AABB leafBox = nodes[leaf].box;
+        int index = root;
+        while (!nodes[index].isLeaf()) {
+            int left = nodes[index].left;
+            int right = nodes[index].right;
+
+            float area = nodes[index].box.getSurfaceArea();
+            float combinedArea = AABB::merge(nodes[index].box, leafBox).getSurfaceArea();
+            float cost = 2.0f * combinedArea;
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](int child) {
+                float merged = AABB::merge(leafBox, nodes[child].box).getSurfaceArea();
+                if (nodes[child].isLeaf()) {
+                    return merged + inheritanceCost;
+                }
+                return merged - nodes[child].box.getSurfaceArea() + inheritanceCost;
+            };
+            float costLeft = descendCost(left);
+            float costRight = descendCost(right);
+
+            if (cost < costLeft && cost < costRight) {
+                break;
+            }
+            index = costLeft < costRight ? left : right;
+        }
+
+        int sibling = index;
+        int oldParent = nodes[sibling].parent;
+        int newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = AABB::merge(leafBox, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].left = sibling;
+        nodes[newParent].right = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent != NULL_NODE) {
+            if (nodes[oldParent].left == sibling) {
+                nodes[oldParent].left = newParent;
+            }
+            else {
+                nodes[oldParent].right = newParent;
+            }
+        }
+        else {
+            root = newParent;
+        }
+
+        refitAncestors(nodes[leaf].parent);
+    }
+
+    void removeLeaf(int leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+
+        int parent = nodes[leaf].parent;
+        int grandParent = nodes[parent].parent;
+        int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        if (grandParent != NULL_NODE) {
+            if (nodes[grandParent].left == parent) {
+                nodes[grandParent].left = sibling;
+            }
+            else {
+                nodes[grandParent].right = sibling;
+            }
+            nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            refitAncestors(grandParent);
+        }
+        else {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            freeNode(parent);
+        }
+    }
+
+    void refitAncestors(int index) {
+        while (index != NULL_NODE) {
+            index = balance(index);
+
+            int left = nodes[index].left;
+            int right = nodes[index].right;
+            nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+            nodes[index].box = AABB::merge(nodes[left].box, nodes[right].box);
+
+            index = nodes[index].parent;
+        }
+    }
+
+    // Rotates the subtree at a if it is unbalanced; returns the new subtree root.
+    int balance(int a) {
+        Node& A = nodes[a];
+        if (A.isLeaf() || A.height < 2) {
+            return a;
+        }
+
+        int b = A.left;
+        int c = A.right;
+        int difference = nodes[c].height - nodes[b].height;
+
+        if (difference > 1) {
+            return rotate(a, c, b);
+        }
+        if (difference < -1) {
+            return rotate(a, b, c);
+        }
+        return a;
+    }
+
+    // Promotes child "up" (the taller one) above a; "other" stays under a.
+    int rotate(int a, int up, int other) {
+        int f = nodes[up].left;
+        int g = nodes[up].right;
+
+        nodes[up].left = a;
+        nodes[up].parent = nodes[a].parent;
+        nodes[a].parent = up;
+
+        if (nodes[up].parent != NULL_NODE) {
+            if (nodes[nodes[up].parent].left == a) {
+                nodes[nodes[up].parent].left = up;
+            }
+            else {
+                nodes[nodes[up].parent].right = up;
+            }
+        }
+        else {
+            root = up;
+        }
+
+        // Keep the taller grandchild under "up", move the shorter one under a.
+        int keep = nodes[f].height > nodes[g].height ? f : g;
+        int move = keep == f ? g : f;
+        nodes[up].right = keep;
+        if (nodes[a].left == up) {
+            nodes[a].left = move;
+        }
+        else {
+            nodes[a].right = move;
+        }
+        nodes[move].parent = a;
+
+        nodes[a].box = AABB::merge(nodes[other].box, nodes[move].box);
+        nodes[a].height = 1 + std::max(nodes[other].height, nodes[move].height);
+        nodes[up].box = AABB::merge(nodes[a].box, nodes[keep].box);
+        nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+        return up;
+    }
+
+    // Height of the subtree at index, or -1 if a link, height or box in it is wrong.
+    int validateSubtree(int index, int parent, int& leaves) const {
+        const Node& node = nodes[index];
+        if (node.parent != parent || node.height < 0) return -1;
+        if (node.isLeaf()) {
+            leaves++;
+            return node.right == NULL_NODE && node.height == 0 ? 0 : -1;
+        }
+        if (node.right == NULL_NODE) return -1;
+
+        int left = validateSubtree(node.left, index, leaves);
+        int right = validateSubtree(node.right, index, leaves);
+        if (left < 0 || right < 0 || node.height != 1 + std::max(left, right)) return -1;
+        if (!node.box.contains(nodes[node.left].box) || !node.box.contains(nodes[node.right].box)) return -1;
+        return node.height;
+    }
+
+public:
+    explicit BVH(float margin = 0.1f) : margin(margin) {
+    }
+
+    int createProxy(const AABB& box, int userData) {
+        int proxy = allocateNode();
+        nodes[proxy].box = box.inflated(margin);
+        nodes[proxy].userData = userData;
+        insertLeaf(proxy);
+        proxyCount++;
+        return proxy;
+    }
+
+    void destroyProxy(int proxy) {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        proxyCount--;
+    }
+
+    // Returns true if the leaf had to be reinserted.
+    bool moveProxy(int proxy, const AABB& box) {
+        if (nodes[proxy].box.contains(box)) {
+            return false;
+        }
+        removeLeaf(proxy);
+        nodes[proxy].box = box.inflated(margin);
+        insertLeaf(proxy);
+        return true;
+    }
+
+    void clear() {
+        nodes.clear();
+        root = NULL_NODE;
+        freeList = NULL_NODE;
+        proxyCount = 0;
+    }
+
+    const AABB& getFatBounds(int proxy) const { return nodes[proxy].box; }
+    int getUserData(int proxy) const { return nodes[proxy].userData; }
+    int getProxyCount() const { return proxyCount; }
+    int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+    // Checks parent/child links, heights, bounds and the free list of the whole tree.
+    // Walks every node, so it is meant for tests.
+    bool validate() const {
+        int leaves = 0;
+        if (root != NULL_NODE && validateSubtree(root, NULL_NODE, leaves) < 0) return false;
+        if (leaves != proxyCount) return false;
+
+        size_t freeNodes = 0;
+        for (int node = freeList; node != NULL_NODE; node = nodes[node].parent) {
+            if (nodes[node].height != -1 || ++freeNodes > nodes.size()) return false;
+        }
+        // A tree with n leaves has n - 1 internal nodes.
+        size_t used = leaves == 0 ? 0 : 2 * static_cast<size_t>(leaves) - 1;
+        return used + freeNodes == nodes.size();
+    }
+
+    // callback(int userData) for every leaf overlapping box.
+    template <typename Callback>
+    void query(const AABB& box, Callback callback) const {
+        if (root == NULL_NODE) return;
+
+        int stack[MAX_STACK];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!node.box.overlaps(box)) {
+                continue;
+            }
+            if (node.isLeaf()) {
+                callback(node.userData);
+            }
+            else {
+                assert(top + 2 <= MAX_STACK);
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+    }
+
+    // callback(int userData) for every leaf whose fat bounds touch the frustum. Subtrees
+    // that are completely inside are reported without further plane tests.
+    template <typename Callback>
+    void queryFrustum(const Frustum& frustum, Callback callback) const {
+        if (root == NULL_NODE) return;
+
+        int stack[MAX_STACK];
+        bool inside[MAX_STACK];
+        int top = 0;
+        stack[top] = root;
+        inside[top++] = false;
+        while (top > 0) {
+            top--;
+            const Node& node = nodes[stack[top]];
+            bool fullyInside = inside[top];
+            if (!fullyInside) {
+                Frustum::Result result = frustum.classify(node.box);
+                if (result == Frustum::Result::Outside) {
+                    continue;
+                }
+                fullyInside = result == Frustum::Result::Inside;
+            }
+            if (node.isLeaf()) {
+                callback(node.userData);
+            }
+            else {
+                assert(top + 2 <= MAX_STACK);
+                stack[top] = node.left;
+                inside[top++] = fullyInside;
+                stack[top] = node.right;
+                inside[top++] = fullyInside;
+            }
+        }
+    }
+
+    // callback(int userData, float distance) for every leaf the ray enters before
+    // maxDistance. The callback returns the new maximum distance (e.g. the distance of
+    // the closest confirmed hit) which prunes the rest of the traversal.
+    template <typename Callback>
+    void raycast(const Ray& ray, float maxDistance, Callback callback) const {
+        if (root == NULL_NODE) return;
+
+        int stack[MAX_STACK];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            float distance;
+            if (!ray.intersects(node.box, maxDistance, distance)) {
+                continue;
+            }
+            if (node.isLeaf()) {
+                maxDistance = callback(node.userData, distance);
+            }
+            else {
+                assert(top + 2 <= MAX_STACK);
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "BakedLighting.h"
\ No newline at end of file
@@ -0,0 +1,255 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Output of the LightmapBaker tool. Static geometry gets a second set of texture
+// coordinates into one RGB atlas holding the diffuse lighting (ambient, direct light
+// with shadows and optional bounces). Exhibits are lit in real time but take their
+// indirect light from a grid of irradiance probes stored as ambient cubes.
+//
+// Nothing here touches GL, so the baker and the viewer share it.
+struct BakedLighting {
+private:
+    static const uint32_t MAGIC = 0x4b425a4d;   // "MZBK"
+    static const uint32_t VERSION = 1;
+
+    struct Writer {
+        std::ofstream& file;
+
+        template <typename T>
+        void pod(const T& value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void vector(const std::vector<T>& values) {
+            pod(static_cast<uint64_t>(values.size()));
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        void string(const std::string& value) {
+            pod(static_cast<uint32_t>(value.size()));
+            file.write(value.data(), value.size());
+        }
+    };
+
+    struct Reader {
+        std::ifstream& file;
+        const std::string& path;
+
+        void read(void* data, size_t bytes) {
+            if (!file.read(static_cast<char*>(data), bytes)) {
+                throw std::runtime_error(path + " is truncated");
+            }
+        }
+
+        template <typename T>
+        T pod() {
+            T value;
+            read(&value, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void vector(std::vector<T>& values) {
+            uint64_t count = pod<uint64_t>();
+            if (count > (1ull << 32)) {
+                throw std::runtime_error(path + " is corrupt");
+            }
+            values.resize(static_cast<size_t>(count));
+            read(values.data(), values.size() * sizeof(T));
+        }
+
+        std::string string() {
+            std::string value(pod<uint32_t>(), '\0');
+            read(&value[0], value.size());
+            return value;
+        }
+    };
+
+public:
+    // Irradiance arriving from the +X, -X, +Y, -Y, +Z and -Z hemispheres.
+    struct AmbientCube {
+        glm::vec3 faces[6];
+
+        AmbientCube() {
+            std::fill(std::begin(faces), std::end(faces), glm::vec3(0.0f));
+        }
+    };
+
+    // Lightmap coordinates per mesh in ObjParser order, two floats per vertex.
+    struct ModelLightmap {
+        uint32_t modelIndex;        // position in the scene file
+        std::string objPath;
+        std::vector<std::vector<float>> meshCoords;
+    };
+
+    uint64_t sceneHash = 0;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    std::vector<float> atlas;                   // RGB, row 0 is v = 0
+    std::vector<ModelLightmap> models;
+
+    glm::vec3 probeOrigin{ 0.0f };
+    float probeSpacing = 1.0f;
+    glm::ivec3 probeCounts{ 0 };
+    std::vector<AmbientCube> probes;            // x fastest, then y, then z
+    std::vector<unsigned char> probeValid;      // 0 for probes stuck inside geometry
+
+    const ModelLightmap* findModel(size_t modelIndex) const {
+        for (const auto& model : models) {
+            if (model.modelIndex == modelIndex) return &model;
+        }
+        return nullptr;
+    }
+
+    // CPU memory held, without the atlas once it has been uploaded and cleared.
+    size_t getMemorySize() const {
+        size_t bytes = atlas.size() * sizeof(float) + probes.size() * sizeof(AmbientCube) + probeValid.size();
+        for (const auto& model : models) {
+            for (const auto& coords : model.meshCoords) {
+                bytes += coords.size() * sizeof(float);
+            }
+        }
+        return bytes;
+    }
+
+    // Trilinear blend of the surrounding probes, skipping invalid ones.
+    AmbientCube sampleProbes(const glm::vec3& position) const {
+        AmbientCube result;
+        if (probes.empty()) return result;
+
+        glm::vec3 cell = (position - probeOrigin) / probeSpacing;
+        glm::ivec3 last = probeCounts - glm::ivec3(1);
+        cell = glm::clamp(cell, glm::vec3(0.0f), glm::vec3(last));
+        glm::ivec3 base = glm::min(glm::ivec3(glm::floor(cell)), glm::max(last - glm::ivec3(1), glm::ivec3(0)));
+        glm::vec3 t = cell - glm::vec3(base);
+
+        float totalWeight = 0.0f;
+        for (int corner = 0; corner < 8; corner++) {
+            glm::ivec3 offset((corner & 1) ? 1 : 0, (corner & 2) ? 1 : 0, (corner & 4) ? 1 : 0);
+            glm::ivec3 probe = glm::min(base + offset, last);
+            size_t index = (static_cast<size_t>(probe.z) * probeCounts.y + probe.y) * probeCounts.x + probe.x;
+            if (!probeValid[index]) continue;
+
+            float weight = (offset.x ? t.x : 1.0f - t.x) * (offset.y ? t.y : 1.0f - t.y) * (offset.z ? t.z : 1.0f - t.z);
+            for (int face = 0; face < 6; face++) {
+                result.faces[face] += probes[index].faces[face] * weight;
+            }
+            totalWeight += weight;
+        }
+        if (totalWeight > 0.0f) {
+            for (auto& face : result.faces) {
+                face /= totalWeight;
+            }
+        }
+        return result;
+    }
+
+    // Bakes are tied to the exact scene file they were made from.
+    static uint64_t hashFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+        uint64_t hash = 14695981039346656037ull;
+        char c;
+        while (file.get(c)) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Creates the directory of path if needed (one level, like the shader cache).
+    void save(const std::string& path) const {
+        size_t slash = path.find_last_of("/\\");
+        if (slash != std::string::npos) {
+#ifdef _WIN32
+            _mkdir(path.substr(0, slash).c_str());
+#else
+            mkdir(path.substr(0, slash).c_str(), 0755);
+#endif
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to create " + path);
+        }
+        Writer out{ file };
+        uint32_t magic = MAGIC, version = VERSION;
+        out.pod(magic);
+        out.pod(version);
+        out.pod(sceneHash);
+        out.pod(atlasWidth);
+        out.pod(atlasHeight);
+        out.vector(atlas);
+        out.pod(static_cast<uint32_t>(models.size()));
+        for (const auto& model : models) {
+            out.pod(model.modelIndex);
+            out.string(model.objPath);
+            out.pod(static_cast<uint32_t>(model.meshCoords.size()));
+            for (const auto& coords : model.meshCoords) {
+                out.vector(coords);
+            }
+        }
+        out.pod(probeOrigin);
+        out.pod(probeSpacing);
+        out.pod(probeCounts);
+        out.vector(probes);
+        out.vector(probeValid);
+        if (!file) {
+            throw std::runtime_error("Failed to write " + path);
+        }
+    }
+
+    static BakedLighting load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open baked lighting: " + path);
+        }
+        Reader in{ file, path };
+        if (in.pod<uint32_t>() != MAGIC || in.pod<uint32_t>() != VERSION) {
+            throw std::runtime_error(path + " is not a baked lighting file of this version");
+        }
+
+        BakedLighting baked;
+        baked.sceneHash = in.pod<uint64_t>();
+        baked.atlasWidth = in.pod<int>();
+        baked.atlasHeight = in.pod<int>();
+        in.vector(baked.atlas);
+        if (baked.atlas.size() != static_cast<size_t>(baked.atlasWidth) * baked.atlasHeight * 3) {
+            throw std::runtime_error(path + ": atlas size does not match its dimensions");
+        }
+        baked.models.resize(in.pod<uint32_t>());
+        for (auto& model : baked.models) {
+            model.modelIndex = in.pod<uint32_t>();
+            model.objPath = in.string();
+            model.meshCoords.resize(in.pod<uint32_t>());
+            for (auto& coords : model.meshCoords) {
+                in.vector(coords);
+            }
+        }
+        baked.probeOrigin = in.pod<glm::vec3>();
+        baked.probeSpacing = in.pod<float>();
+        baked.probeCounts = in.pod<glm::ivec3>();
+        in.vector(baked.probes);
+        in.vector(baked.probeValid);
+        size_t probeCount = static_cast<size_t>(baked.probeCounts.x) * baked.probeCounts.y * baked.probeCounts.z;
+        if (baked.probes.size() != probeCount || baked.probeValid.size() != probeCount) {
+            throw std::runtime_error(path + ": probe grid does not match its dimensions");
+        }
+        return baked;
+    }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "Bounds.h"
\ No newline at end of file
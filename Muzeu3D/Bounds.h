@@ -0,0 +1,152 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <limits>
+
+struct AABB {
+    glm::vec3 min{ std::numeric_limits<float>::max() };
+    glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+    AABB() {
+    }
+
+    AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {
+    }
+
+    bool isValid() const {
+        return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+    }
+
+    void expand(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtent() const { return (max - min) * 0.5f; }
+
+    float getSurfaceArea() const {
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    bool contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+            max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+            min.y <= other.max.y && max.y >= other.min.y &&
+            min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    AABB inflated(float amount) const {
+        return AABB(min - glm::vec3(amount), max + glm::vec3(amount));
+    }
+
+    static AABB merge(const AABB& a, const AABB& b) {
+        return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+
+    // Bounds of this box after transform (Arvo's method, exact for affine matrices).
+    AABB transformed(const glm::mat4& transform) const {
+        glm::vec3 translation(transform[3]);
+        AABB result(translation, translation);
+        for (int column = 0; column < 3; column++) {
+            for (int row = 0; row < 3; row++) {
+                float a = transform[column][row] * min[column];
+                float b = transform[column][row] * max[column];
+                result.min[row] += std::min(a, b);
+                result.max[row] += std::max(a, b);
+            }
+        }
+        return result;
+    }
+};
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    // Slab test; on hit tEntry is the distance along the ray to the box (0 if inside).
+    bool intersects(const AABB& box, float maxDistance, float& tEntry) const {
+        float tMin = 0.0f;
+        float tMax = maxDistance;
+        for (int axis = 0; axis < 3; axis++) {
+            float invD = 1.0f / direction[axis];
+            float t0 = (box.min[axis] - origin[axis]) * invD;
+            float t1 = (box.max[axis] - origin[axis]) * invD;
+            if (invD < 0.0f) {
+                std::swap(t0, t1);
+            }
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+            if (tMax < tMin) {
+                return false;
+            }
+        }
+        tEntry = tMin;
+        return true;
+    }
+};
+
+class Frustum {
+public:
+    enum class Result {
+        Outside,
+        Intersects,
+        Inside
+    };
+
+private:
+    glm::vec4 planes[6];
+
+public:
+    Frustum() {
+    }
+
+    // Extracts the six clip planes of a view-projection matrix (Gribb/Hartmann).
+    explicit Frustum(const glm::mat4& viewProjection) {
+        glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        planes[0] = row3 + row0;
+        planes[1] = row3 - row0;
+        planes[2] = row3 + row1;
+        planes[3] = row3 - row1;
+        planes[4] = row3 + row2;
+        planes[5] = row3 - row2;
+
+        for (glm::vec4& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    Result classify(const AABB& box) const {
+        Result result = Result::Inside;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 normal(plane);
+            glm::vec3 positive(normal.x >= 0.0f ? box.max.x : box.min.x,
+                normal.y >= 0.0f ? box.max.y : box.min.y,
+                normal.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(normal, positive) + plane.w < 0.0f) {
+                return Result::Outside;
+            }
+
+            glm::vec3 negative(normal.x >= 0.0f ? box.min.x : box.max.x,
+                normal.y >= 0.0f ? box.min.y : box.max.y,
+                normal.z >= 0.0f ? box.min.z : box.max.z);
+            if (glm::dot(normal, negative) + plane.w < 0.0f) {
+                result = Result::Intersects;
+            }
+        }
+        return result;
+    }
+
+    bool intersects(const AABB& box) const {
+        return classify(box) != Result::Outside;
+    }
+};
\ No newline at end of file
@@ -3,18 +3,22 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <functional>
 
 class Camera {
 private:
     glm::vec3 position;
+    glm::vec3 previousPosition;
     glm::vec3 front;
     glm::vec3 up;
     float yaw, pitch;
-    const float SPEED = 0.02f;
+    const float SPEED = 1.2f; // units per second
+    std::function<bool(const glm::vec3&)> collisionTest;
 
 public:
     Camera(const glm::vec3& pos = glm::vec3(0.0f, 3.0f, 0.0f))
         : position(pos),
+        previousPosition(pos),
         front(glm::vec3(0.0f, 0.0f, -1.0f)),
         up(glm::vec3(0.0f, 1.0f, 0.0f)),
         yaw(-90.0f),
@@ -44,20 +48,24 @@ public:
     }
 
     void processKeyboard(GLFWwindow* window, float deltaTime) {
+        previousPosition = position;
         glm::vec3 newPos = position;
+        float velocity = SPEED * deltaTime;
 
         if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-            newPos += SPEED * front;
+            newPos += velocity * front;
         if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-            newPos -= SPEED * front;
+            newPos -= velocity * front;
         if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-            newPos -= glm::normalize(glm::cross(front, up)) * SPEED;
+            newPos -= glm::normalize(glm::cross(front, up)) * velocity;
         if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-            newPos += glm::normalize(glm::cross(front, up)) * SPEED;
+            newPos += glm::normalize(glm::cross(front, up)) * velocity;
 
         newPos.y = 3.1f;
 
-        if (isPositionValid(newPos)) 
+        // Moving out of an exhibit is always allowed so the camera can never get stuck.
+        bool blocked = collisionTest && collisionTest(newPos) && !collisionTest(position);
+        if (isPositionValid(newPos) && !blocked) 
         {
             position = newPos;
         }
@@ -91,7 +99,30 @@ public:
         return glm::lookAt(position, position + front, up);
     }
 
+    // View matrix between the last two fixed updates, alpha in [0, 1].
+    glm::mat4 getViewMatrix(float alpha) const {
+        glm::vec3 pos = getPosition(alpha);
+        return glm::lookAt(pos, pos + front, up);
+    }
+
     glm::vec3 getPosition() const {
         return position;
     }
+
+    glm::vec3 getFront() const {
+        return front;
+    }
+
+    // Returns true if the camera would collide with scene geometry at the given position.
+    void setCollisionTest(std::function<bool(const glm::vec3&)> test) {
+        collisionTest = std::move(test);
+    }
+
+    bool isMoving() const {
+        return position != previousPosition;
+    }
+
+    glm::vec3 getPosition(float alpha) const {
+        return glm::mix(previousPosition, position, alpha);
+    }
 };
\ No newline at end of file
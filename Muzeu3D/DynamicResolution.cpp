@@ -0,0 +1 @@
+#include "DynamicResolution.h"
\ No newline at end of file
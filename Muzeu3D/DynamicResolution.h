@@ -0,0 +1,129 @@
+#pragma once
+#include <GL/glew.h>
+#include <algorithm>
+#include <stdexcept>
+#include "GpuTimer.h"
+#include "RenderCommandList.h"
+#include "ResourceRegistry.h"
+#include "ResolutionController.h"
+
+// Renders the main pass into an offscreen target at a fraction of the output size
+// and stretches it onto the window. The target is allocated once at full size and
+// only the viewport shrinks, so scale changes never reallocate. At full scale the
+// pass goes straight to the window and the copy is skipped.
+//
+// Constructed and destroyed with the GL context current; the timer queries run in
+// recorded tasks on the render thread.
+class DynamicResolution {
+private:
+    int width;
+    int height;
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+    uint64_t resourceIds[3] = {};
+
+    GpuTimer timer;
+    ResolutionController controller;
+    bool enabled = true;
+    double lastGpuMilliseconds = 0.0;
+
+    int renderWidth;
+    int renderHeight;
+
+    void applyScale(float scale) {
+        renderWidth = std::max(1, static_cast<int>(width * scale + 0.5f));
+        renderHeight = std::max(1, static_cast<int>(height * scale + 0.5f));
+    }
+
+public:
+    DynamicResolution(int width, int height,
+        const ResolutionControllerSettings& settings = ResolutionControllerSettings())
+        : width(width), height(height), controller(settings) {
+        applyScale(controller.getScale());
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &colorBuffer);
+            glDeleteRenderbuffers(1, &depthBuffer);
+            throw std::runtime_error("Failed to create the dynamic resolution render target");
+        }
+
+        ResourceRegistry& registry = ResourceRegistry::global();
+        size_t pixels = static_cast<size_t>(width) * height;
+        resourceIds[0] = registry.track(ResourceCategory::RenderTarget, "DynamicResolution", 0);
+        resourceIds[1] = registry.track(ResourceCategory::RenderTarget, "DynamicResolution", pixels * 4);
+        resourceIds[2] = registry.track(ResourceCategory::RenderTarget, "DynamicResolution", pixels * 4);
+    }
+
+    ~DynamicResolution() {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        for (uint64_t id : resourceIds) {
+            ResourceRegistry::global().release(id);
+        }
+    }
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Feeds the newest GPU frame time to the controller and picks the size of the
+    // next frame; returns true when it changed.
+    bool update() {
+        double milliseconds;
+        if (!timer.takeSample(milliseconds)) return false;
+        lastGpuMilliseconds = milliseconds;
+        if (!enabled || !controller.addSample(milliseconds)) return false;
+
+        applyScale(controller.getScale());
+        return true;
+    }
+
+    // Everything recorded between beginFrame and endFrame is timed; only work whose cost
+    // follows the render scale belongs in there.
+    void beginFrame(RenderCommandList& list) {
+        list.runTask([this] { timer.begin(); });
+    }
+
+    // Binds the target of the main pass and sets its viewport.
+    void bindTarget(RenderCommandList& list) const {
+        list.bindFramebuffer(isScaled() ? framebuffer : 0);
+        list.setViewport(0, 0, renderWidth, renderHeight);
+    }
+
+    void endFrame(RenderCommandList& list) {
+        if (isScaled()) {
+            list.blitToDefault(framebuffer, renderWidth, renderHeight, width, height);
+        }
+        list.runTask([this] { timer.end(); });
+    }
+
+    void setEnabled(bool value) {
+        if (enabled == value) return;
+        enabled = value;
+        controller.reset();
+        applyScale(enabled ? controller.getScale() : 1.0f);
+    }
+
+    bool isEnabled() const { return enabled; }
+    bool isSettling() const { return enabled && controller.isSettling(); }
+    bool isScaled() const { return renderWidth != width || renderHeight != height; }
+    float getScale() const { return static_cast<float>(renderWidth) / width; }
+    int getRenderWidth() const { return renderWidth; }
+    int getRenderHeight() const { return renderHeight; }
+    double getLastGpuMilliseconds() const { return lastGpuMilliseconds; }
+};
\ No newline at end of file
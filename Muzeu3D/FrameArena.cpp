@@ -0,0 +1 @@
+#include "FrameArena.h"
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that only lives while one frame is recorded: allocating
+// bumps a pointer and reset() at the end of the frame drops everything at once. A
+// frame that outgrows the block spills into extra blocks, and the next reset()
+// replaces them with a single block large enough for that frame, so once the working
+// set is known recording a frame makes no heap allocations.
+//
+// Nothing is destroyed on reset(), so only trivially destructible types go in here.
+class FrameArena {
+private:
+    std::unique_ptr<unsigned char[]> block;
+    size_t capacity;
+    size_t used = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow;
+    size_t overflowBytes = 0;
+    size_t peakBytes = 0;
+    uint64_t growths = 0;
+
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024)
+        : block(new unsigned char[capacity]), capacity(capacity) {
+        overflow.reserve(16);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // alignment must be a power of two no larger than alignof(std::max_align_t).
+    void* allocate(size_t bytes, size_t alignment) {
+        size_t offset = (used + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes <= capacity) {
+            used = offset + bytes;
+            return block.get() + offset;
+        }
+        overflow.emplace_back(new unsigned char[std::max<size_t>(bytes, 1)]);
+        overflowBytes += bytes + alignment;
+        return overflow.back().get();
+    }
+
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena does not run destructors");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "FrameArena does not over-align");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Ends the frame. Everything allocated since the last reset() becomes invalid.
+    void reset() {
+        size_t frameBytes = used + overflowBytes;
+        peakBytes = std::max(peakBytes, frameBytes);
+        if (!overflow.empty()) {
+            overflow.clear();
+            capacity = std::max(capacity * 2, frameBytes);
+            block.reset(new unsigned char[capacity]);
+            growths++;
+        }
+        used = 0;
+        overflowBytes = 0;
+    }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getPeakBytes() const { return peakBytes; }
+    uint64_t getGrowths() const { return growths; }
+};
+
+// Scratch list in a FrameArena for per-frame data whose upper bound is known when the
+// list is started (draw lists, visible sets). Valid until the arena is reset. Going
+// past the bound still works: the items move to a larger array in the same arena.
+template <typename T>
+class FrameArray {
+private:
+    FrameArena* arena = nullptr;
+    T* items = nullptr;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    void grow() {
+        if (!arena) {
+            throw std::length_error("FrameArray without an arena is full");
+        }
+        size_t newCapacity = std::max<size_t>(capacity * 2, 16);
+        T* newItems = arena->allocate<T>(newCapacity);
+        std::uninitialized_copy(items, items + count, newItems);
+        items = newItems;
+        capacity = newCapacity;
+    }
+
+public:
+    FrameArray() = default;
+
+    FrameArray(FrameArena& arena, size_t capacity)
+        : arena(&arena), items(capacity ? arena.allocate<T>(capacity) : nullptr), capacity(capacity) {
+    }
+
+    // The old array stays valid until the arena is reset, so item may point into it.
+    void push_back(const T& item) {
+        if (count == capacity) {
+            grow();
+        }
+        new (items + count++) T(item);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t index) { return items[index]; }
+    const T& operator[](size_t index) const { return items[index]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+};
\ No newline at end of file
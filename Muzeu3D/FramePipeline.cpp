@@ -0,0 +1 @@
+#include "FramePipeline.h"
\ No newline at end of file
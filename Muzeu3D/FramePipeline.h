@@ -0,0 +1,105 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include "RenderCommandList.h"
+
+// Double-buffered hand-off between the thread that records frames and the thread
+// that submits them to GL.
+//
+// Ownership of each list moves Free -> Recording (producer) -> Ready (pipeline)
+// -> Executing (consumer) -> Free. Only the current owner may touch a list, and
+// slots are used strictly in order, so the producer can record frame N+1 while
+// the consumer executes frame N, but never gets more than one frame ahead.
+class FramePipeline {
+private:
+    enum class SlotState {
+        Free,
+        Recording,
+        Ready,
+        Executing
+    };
+
+    static const int SLOT_COUNT = 2;
+
+    RenderCommandList lists[SLOT_COUNT];
+    SlotState states[SLOT_COUNT] = { SlotState::Free, SlotState::Free };
+    int nextRecordSlot = 0;
+    int nextExecuteSlot = 0;
+    uint64_t recordedFrames = 0;
+    bool stopped = false;
+
+    std::mutex mutex;
+    std::condition_variable slotChanged;
+
+    int slotOf(const RenderCommandList* list) const {
+        return static_cast<int>(list - lists);
+    }
+
+public:
+    // Blocks until the next slot has been executed. Returns nullptr after stop().
+    RenderCommandList* beginRecording() {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotChanged.wait(lock, [this] { return stopped || states[nextRecordSlot] == SlotState::Free; });
+        if (stopped) {
+            return nullptr;
+        }
+
+        int slot = nextRecordSlot;
+        nextRecordSlot = (nextRecordSlot + 1) % SLOT_COUNT;
+        states[slot] = SlotState::Recording;
+        lists[slot].reset(recordedFrames++);
+        return &lists[slot];
+    }
+
+    void submit(RenderCommandList* list) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            states[slotOf(list)] = SlotState::Ready;
+        }
+        slotChanged.notify_all();
+    }
+
+    // Blocks until a submitted list is available. Returns nullptr once stop() was
+    // called and every submitted list has been handed out.
+    RenderCommandList* beginExecution() {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotChanged.wait(lock, [this] { return stopped || states[nextExecuteSlot] == SlotState::Ready; });
+        if (states[nextExecuteSlot] != SlotState::Ready) {
+            return nullptr;
+        }
+
+        int slot = nextExecuteSlot;
+        nextExecuteSlot = (nextExecuteSlot + 1) % SLOT_COUNT;
+        states[slot] = SlotState::Executing;
+        return &lists[slot];
+    }
+
+    void endExecution(RenderCommandList* list) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            states[slotOf(list)] = SlotState::Free;
+        }
+        slotChanged.notify_all();
+    }
+
+    // Blocks until every submitted list has been executed.
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotChanged.wait(lock, [this] {
+            for (SlotState state : states) {
+                if (state == SlotState::Ready || state == SlotState::Executing) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        slotChanged.notify_all();
+    }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "FrameScheduler.h"
\ No newline at end of file
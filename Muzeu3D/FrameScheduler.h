@@ -0,0 +1,129 @@
+#pragma once
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+enum class VSyncMode {
+    Off,
+    On,
+    Adaptive
+};
+
+struct FrameSchedulerSettings {
+    double fixedTimeStep = 1.0 / 60.0;
+    int maxStepsPerFrame = 5;
+    double maxFrameRate = 0.0;           // 0 = uncapped (vsync only)
+    VSyncMode vsync = VSyncMode::Adaptive;
+    bool sleepWhenIdle = true;
+    double idleTimeout = 120.0;          // seconds without input before going idle
+    double idleFrameRate = 2.0;
+    double skippedFrameWait = 0.25;      // max block time when there was nothing to redraw
+    bool pauseAnimationsWhenIdle = true;
+};
+
+// Fixed-step simulation with variable-rate rendering: update() runs in steps of
+// fixedTimeStep, render() runs as often as the frame cap allows and interpolates.
+class FrameScheduler {
+private:
+    FrameSchedulerSettings settings;
+    double previousTime = 0.0;
+    double frameStartTime = 0.0;
+    double accumulator = 0.0;
+    double lastInputTime = 0.0;
+    bool idle = false;
+
+public:
+    FrameScheduler(const FrameSchedulerSettings& settings = FrameSchedulerSettings())
+        : settings(settings) {
+    }
+
+    // Applies to the context current on the calling thread.
+    void applyVSync() const {
+        switch (settings.vsync) {
+        case VSyncMode::Off:
+            glfwSwapInterval(0);
+            break;
+        case VSyncMode::On:
+            glfwSwapInterval(1);
+            break;
+        case VSyncMode::Adaptive:
+            if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                glfwSwapInterval(-1);
+            }
+            else {
+                glfwSwapInterval(1);
+            }
+            break;
+        }
+    }
+
+    void start() {
+        previousTime = glfwGetTime();
+        frameStartTime = previousTime;
+        lastInputTime = previousTime;
+        accumulator = 0.0;
+        idle = false;
+    }
+
+    // Returns how many fixed update steps the current frame has to run.
+    int beginFrame() {
+        frameStartTime = glfwGetTime();
+        double frameTime = frameStartTime - previousTime;
+        previousTime = frameStartTime;
+
+        double maxFrameTime = settings.fixedTimeStep * settings.maxStepsPerFrame;
+        accumulator += std::min(frameTime, maxFrameTime);
+
+        int steps = 0;
+        while (accumulator >= settings.fixedTimeStep && steps < settings.maxStepsPerFrame) {
+            accumulator -= settings.fixedTimeStep;
+            steps++;
+        }
+        if (steps == settings.maxStepsPerFrame) {
+            accumulator = std::min(accumulator, settings.fixedTimeStep);
+        }
+
+        idle = settings.sleepWhenIdle && (frameStartTime - lastInputTime) > settings.idleTimeout;
+        return steps;
+    }
+
+    // Waits for the next frame slot and pumps window events. While idle, or when the
+    // frame was skipped because nothing changed, it blocks in glfwWaitEventsTimeout
+    // so any input wakes the application immediately.
+    void endFrame(bool presented = true) {
+        if (!presented) {
+            glfwWaitEventsTimeout(settings.skippedFrameWait);
+            return;
+        }
+
+        double targetRate = idle ? settings.idleFrameRate : settings.maxFrameRate;
+        if (targetRate <= 0.0) {
+            glfwPollEvents();
+            return;
+        }
+
+        double remaining = (1.0 / targetRate) - (glfwGetTime() - frameStartTime);
+        if (remaining <= 0.0) {
+            glfwPollEvents();
+        }
+        else if (idle) {
+            glfwWaitEventsTimeout(remaining);
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+            glfwPollEvents();
+        }
+    }
+
+    void notifyInput() {
+        lastInputTime = glfwGetTime();
+        idle = false;
+    }
+
+    float getFixedTimeStep() const { return static_cast<float>(settings.fixedTimeStep); }
+    float getAlpha() const { return static_cast<float>(accumulator / settings.fixedTimeStep); }
+    bool isIdle() const { return idle; }
+    const FrameSchedulerSettings& getSettings() const { return settings; }
+};
\ No newline at end of file
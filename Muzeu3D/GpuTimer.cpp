@@ -0,0 +1 @@
+#include "GpuTimer.h"
\ No newline at end of file
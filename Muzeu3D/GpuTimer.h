@@ -0,0 +1,74 @@
+#pragma once
+#include <GL/glew.h>
+#include <mutex>
+
+// Measures GPU time between begin() and end() with GL_TIME_ELAPSED queries. Results
+// arrive a few frames late; queries are only read once available, so the GPU is
+// never waited on, and frames are left untimed while every query is in flight.
+//
+// begin(), end() and the destructor run on the GL thread; takeSample() on any thread.
+class GpuTimer {
+private:
+    static const int QUERY_COUNT = 4;
+
+    GLuint queries[QUERY_COUNT] = {};
+    int oldest = 0;
+    int pending = 0;
+    bool running = false;
+
+    std::mutex mutex;
+    double latestMilliseconds = 0.0;
+    bool hasSample = false;
+
+    void collect() {
+        while (pending > 0) {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+            oldest = (oldest + 1) % QUERY_COUNT;
+            pending--;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            latestMilliseconds = nanoseconds / 1.0e6;
+            hasSample = true;
+        }
+    }
+
+public:
+    GpuTimer() {
+        glGenQueries(QUERY_COUNT, queries);
+    }
+
+    ~GpuTimer() {
+        glDeleteQueries(QUERY_COUNT, queries);
+    }
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin() {
+        collect();
+        if (pending == QUERY_COUNT) return;
+        glBeginQuery(GL_TIME_ELAPSED, queries[(oldest + pending) % QUERY_COUNT]);
+        running = true;
+    }
+
+    void end() {
+        if (!running) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        running = false;
+        pending++;
+    }
+
+    // Hands out the newest finished measurement once.
+    bool takeSample(double& milliseconds) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hasSample) return false;
+        milliseconds = latestMilliseconds;
+        hasSample = false;
+        return true;
+    }
+};
\ No newline at end of file
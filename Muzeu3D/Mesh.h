@@ -2,21 +2,30 @@
 #include <GL/glew.h>
 #include <vector>
 #include <memory>
+#include <string>
+#include "ResourceRegistry.h"
 #include "Texture.h"
 #include "Shader.h"
+#include "RenderCommandList.h"
 
 class Mesh {
 private:
     GLuint VAO, VBO, EBO;
-    std::vector<GLfloat> vertices;
-    std::vector<GLuint> indices;
+    GLuint lightmapVBO = 0;
+    // The data lives in the buffers only; no CPU copy is kept after the upload.
+    GLsizei indexCount;
     std::shared_ptr<Texture> texture;
+    uint64_t resourceIds[4] = {};
 
 public:
+    // lightmapCoords (two per vertex, attribute 3) is empty unless the mesh is baked.
+    // owner names the model in the resource registry.
     Mesh(const std::vector<GLfloat>& vertices,
         const std::vector<GLuint>& indices,
-        std::shared_ptr<Texture> texture)
-        : vertices(vertices), indices(indices), texture(texture) {
+        std::shared_ptr<Texture> texture,
+        const std::vector<GLfloat>& lightmapCoords = {},
+        const std::string& owner = "unnamed mesh")
+        : indexCount(static_cast<GLsizei>(indices.size())), texture(texture) {
 
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -41,19 +50,45 @@ public:
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));
         glEnableVertexAttribArray(2);
 
+        if (!lightmapCoords.empty()) {
+            glGenBuffers(1, &lightmapVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, lightmapVBO);
+            glBufferData(GL_ARRAY_BUFFER, lightmapCoords.size() * sizeof(GLfloat), lightmapCoords.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (void*)0);
+            glEnableVertexAttribArray(3);
+        }
+
         glBindVertexArray(0);
+
+        ResourceRegistry& registry = ResourceRegistry::global();
+        resourceIds[0] = registry.track(ResourceCategory::Geometry, owner, 0);
+        resourceIds[1] = registry.track(ResourceCategory::Geometry, owner, vertices.size() * sizeof(GLfloat));
+        resourceIds[2] = registry.track(ResourceCategory::Geometry, owner, indices.size() * sizeof(GLuint));
+        if (lightmapVBO) {
+            resourceIds[3] = registry.track(ResourceCategory::Geometry, owner, lightmapCoords.size() * sizeof(GLfloat));
+        }
     }
 
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
     ~Mesh() {
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
         glDeleteBuffers(1, &EBO);
+        if (lightmapVBO) {
+            glDeleteBuffers(1, &lightmapVBO);
+        }
+        for (uint64_t id : resourceIds) {
+            ResourceRegistry::global().release(id);
+        }
     }
 
-    void draw(Shader& shader) {
-        texture->bind();
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    void record(RenderCommandList& list) const {
+        list.bindTexture(0, texture->getID());
+        list.drawIndexed(VAO, indexCount);
     }
+
+    size_t getTriangleCount() const { return static_cast<size_t>(indexCount) / 3; }
+    bool hasLightmap() const { return lightmapVBO != 0; }
 };
\ No newline at end of file
@@ -0,0 +1 @@
+#include "MipStreamingPolicy.h"
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct MipStreamingSettings {
+    size_t budget = 512u * 1024u * 1024u;  // all streamed textures together
+    float lodBias = 0.0f;                   // positive values pick coarser levels
+    int maxLoadsInFlight = 2;
+    uint64_t keepFrames = 300;              // unseen textures keep their mips this long
+};
+
+// Decides which mip levels of the streamed textures should be on the GPU. Level 0 is
+// the full image; a texture holds every level from its resident level down to 1x1.
+// Feedback comes from the projected size of the models using a texture. Textures in
+// recent use keep finer levels than they currently need, so walking back and forth
+// does not reload them; levels are only dropped once a texture has not been seen for
+// keepFrames, or to get under the budget, least visible textures first.
+//
+// No GL here: the caller applies the returned changes and reports finished loads,
+// so the policy can be driven by synthetic feedback.
+class MipStreamingPolicy {
+public:
+    struct TextureState {
+        int width = 1;                  // of level 0
+        int height = 1;
+        int bytesPerTexel = 4;
+        int residentLevel = 0;          // finest level on the GPU
+        int coarsestLevel = 0;          // uploaded with the model, never evicted
+        bool loading = false;
+
+        // Feedback, updated by addFeedback()
+        int wantedLevel = INT_MAX;
+        float priority = 0.0f;          // projected size in pixels
+        uint64_t lastSeenFrame = 0;
+        bool seen = false;
+    };
+
+    struct Change {
+        size_t texture;
+        int level;                      // new finest level
+        bool load;                      // false: drop the levels finer than level
+    };
+
+private:
+    MipStreamingSettings settings;
+    std::vector<int> targets;
+    std::vector<size_t> order;
+
+public:
+    MipStreamingPolicy(const MipStreamingSettings& settings = MipStreamingSettings()) : settings(settings) {
+    }
+
+    static int levelCount(int width, int height) {
+        int size = std::max(width, height);
+        int count = 1;
+        while (size > 1) {
+            size >>= 1;
+            count++;
+        }
+        return count;
+    }
+
+    static size_t levelBytes(const TextureState& texture, int level) {
+        size_t width = static_cast<size_t>(std::max(1, texture.width >> level));
+        size_t height = static_cast<size_t>(std::max(1, texture.height >> level));
+        return width * height * texture.bytesPerTexel;
+    }
+
+    // Memory of the chain from level down to 1x1.
+    static size_t chainBytes(const TextureState& texture, int level) {
+        size_t bytes = 0;
+        for (int i = level; i < levelCount(texture.width, texture.height); i++) {
+            bytes += levelBytes(texture, i);
+        }
+        return bytes;
+    }
+
+    // Finest level worth sampling for a texture stretched over projectedPixels on screen.
+    int requiredLevel(const TextureState& texture, float projectedPixels) const {
+        float size = static_cast<float>(std::max(texture.width, texture.height));
+        float level = std::log2(size / std::max(projectedPixels, 1.0f)) + settings.lodBias;
+        int last = levelCount(texture.width, texture.height) - 1;
+        return std::min(last, std::max(0, static_cast<int>(std::floor(level))));
+    }
+
+    // A texture used by several visible models takes the finest level any of them needs.
+    void addFeedback(TextureState& texture, float projectedPixels, uint64_t frame) {
+        int level = requiredLevel(texture, projectedPixels);
+        if (!texture.seen || texture.lastSeenFrame != frame) {
+            texture.wantedLevel = level;
+            texture.priority = projectedPixels;
+        }
+        else {
+            texture.wantedLevel = std::min(texture.wantedLevel, level);
+            texture.priority = std::max(texture.priority, projectedPixels);
+        }
+        texture.lastSeenFrame = frame;
+        texture.seen = true;
+    }
+
+    // Fills changes with the evictions and the loads to start this frame. Evictions apply
+    // at once; loads set loading and finish later through the caller. changes is
+    // cleared first and can be reused from frame to frame without allocating.
+    void plan(std::vector<TextureState>& textures, uint64_t frame, std::vector<Change>& changes) {
+        targets.resize(textures.size());
+        size_t total = 0;
+        for (size_t i = 0; i < textures.size(); i++) {
+            const TextureState& texture = textures[i];
+            bool recent = texture.seen && frame - texture.lastSeenFrame <= settings.keepFrames;
+            targets[i] = recent ? std::min({ texture.wantedLevel, texture.residentLevel, texture.coarsestLevel })
+                : texture.coarsestLevel;
+            total += chainBytes(texture, targets[i]);
+        }
+
+        // Over budget: coarsen the least visible textures one level at a time.
+        order.resize(textures.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return textures[a].priority < textures[b].priority;
+        });
+        bool reduced = true;
+        while (total > settings.budget && reduced) {
+            reduced = false;
+            for (size_t i : order) {
+                if (targets[i] >= textures[i].coarsestLevel) continue;
+                total -= levelBytes(textures[i], targets[i]);
+                targets[i]++;
+                reduced = true;
+                break;
+            }
+        }
+
+        changes.clear();
+        int loading = 0;
+        for (const TextureState& texture : textures) {
+            loading += texture.loading;
+        }
+        for (size_t i : order) {
+            TextureState& texture = textures[i];
+            if (texture.loading) continue;
+            if (targets[i] > texture.residentLevel) {
+                changes.push_back({ i, targets[i], false });
+                texture.residentLevel = targets[i];
+            }
+        }
+        // Loads go to the most visible textures first.
+        for (auto it = order.rbegin(); it != order.rend() && loading < settings.maxLoadsInFlight; ++it) {
+            TextureState& texture = textures[*it];
+            if (texture.loading || targets[*it] >= texture.residentLevel) continue;
+            changes.push_back({ *it, targets[*it], true });
+            texture.loading = true;
+            loading++;
+        }
+    }
+
+    // Called when a load started by plan() has reached the GPU.
+    static void finishLoad(TextureState& texture, int level) {
+        texture.loading = false;
+        texture.residentLevel = std::min(texture.residentLevel, level);
+    }
+
+    static size_t residentBytes(const std::vector<TextureState>& textures) {
+        size_t bytes = 0;
+        for (const TextureState& texture : textures) {
+            bytes += chainBytes(texture, texture.residentLevel);
+        }
+        return bytes;
+    }
+
+    const MipStreamingSettings& getSettings() const { return settings; }
+};
\ No newline at end of file
@@ -2,104 +2,137 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <tiny_obj_loader.h>
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <unordered_map> 
 #include <fstream>
 #include <iostream>
 #include "Mesh.h"
+#include "Bounds.h"
+#include "JobSystem.h"
+#include "ObjParser.h"
 #include <string>
 
-class Model {
-private:
-    std::vector<std::shared_ptr<Mesh>> meshes;
-    glm::vec3 position{ 0.0f };
-    glm::vec3 rotation{ 0.0f };
-    glm::vec3 scale{ 1.0f };
-    std::string name;
-
-public:
-    Model(const char* objPath, const char* mtlBaseDir) {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
-
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objPath, mtlBaseDir)) {
-            throw std::runtime_error(warn + err);
+// CPU side of a model: interleaved vertex data per shape and the decoded textures it
+// references. load() does not touch GL, so models can be parsed on worker threads and
+// uploaded afterwards by the thread that owns the context.
+struct ModelData {
+    struct MeshData {
+        std::vector<GLfloat> vertices;
+        std::vector<GLuint> indices;
+        std::string texturePath;
+        std::vector<GLfloat> lightmapCoords;    // filled from baked lighting, if any
+    };
+
+    std::vector<MeshData> meshes;
+    std::unordered_map<std::string, TextureData> textures;
+    AABB bounds;
+
+    // Approximate memory once uploaded (vertex and index buffers, textures with mips).
+    // Textures count at their start size; finer mips are budgeted by the texture streamer.
+    size_t getMemorySize() const {
+        size_t bytes = 0;
+        for (const auto& mesh : meshes) {
+            bytes += (mesh.vertices.size() + mesh.lightmapCoords.size()) * sizeof(GLfloat) + mesh.indices.size() * sizeof(GLuint);
         }
+        for (const auto& texture : textures) {
+            bytes += static_cast<size_t>(texture.second.width) * texture.second.height * texture.second.channels * 4 / 3;
+        }
+        return bytes;
+    }
 
-        std::unordered_map<std::string, std::shared_ptr<Texture>> loadedTextures;
-
-        for (const auto& shape : shapes) {
-            std::vector<GLfloat> vertices;
-            std::vector<GLuint> indices;
+    // Chunks of large OBJ files are parsed in parallel on jobs when given.
+    static ModelData load(const char* objPath, const char* mtlBaseDir, JobSystem* jobs = nullptr) {
+        ObjParser::Result parsed = ObjParser::load(objPath, mtlBaseDir, jobs);
 
-            for (const auto& index : shape.mesh.indices) {
-                vertices.push_back(attrib.vertices[3 * index.vertex_index + 0]);
-                vertices.push_back(attrib.vertices[3 * index.vertex_index + 1]);
-                vertices.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+        ModelData data;
+        data.bounds = parsed.bounds;
 
-                if (index.normal_index >= 0) {
-                    vertices.push_back(attrib.normals[3 * index.normal_index + 0]);
-                    vertices.push_back(attrib.normals[3 * index.normal_index + 1]);
-                    vertices.push_back(attrib.normals[3 * index.normal_index + 2]);
-                }
-                else {
-                    vertices.push_back(0.0f);
-                    vertices.push_back(1.0f);
-                    vertices.push_back(0.0f);
-                }
+        for (auto& shape : parsed.meshes) {
+            MeshData mesh;
+            mesh.vertices = std::move(shape.vertices);
+            mesh.indices = std::move(shape.indices);
 
-                if (index.texcoord_index >= 0) {
-                    vertices.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
-                    vertices.push_back(attrib.texcoords[2 * index.texcoord_index + 1]);
-                }
-                else {
-                    vertices.push_back(0.0f);
-                    vertices.push_back(0.0f);
-                }
+            if (!shape.diffuseTexture.empty()) {
+                mesh.texturePath = std::string(mtlBaseDir) + shape.diffuseTexture;
+            }
 
-                indices.push_back(static_cast<GLuint>(indices.size()));
+            if (mesh.texturePath.empty()) {
+                std::cout << "Using default texture for shape in " << objPath << std::endl;
+                mesh.texturePath = "../Textures/default.png";
             }
+            else {
+                std::cout << "Attempting to load texture from: " << mesh.texturePath << std::endl;
 
-            std::shared_ptr<Texture> texture;
-            if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0) {
-                const auto& material = materials[shape.mesh.material_ids[0]];
-                if (!material.diffuse_texname.empty()) {
-                    std::string texPath = std::string(mtlBaseDir) + material.diffuse_texname;
-                    std::cout << "Attempting to load texture from: " << texPath << std::endl;
-
-                    std::ifstream f(texPath.c_str());
-                    if (!f.good()) {
-                        std::cerr << "Warning: Texture file not found: " << texPath << std::endl;
-                    }
-                    f.close();
-
-                    if (loadedTextures.find(texPath) == loadedTextures.end()) {
-                        texture = std::make_shared<Texture>(texPath.c_str());
-                        loadedTextures[texPath] = texture;
-                    }
-                    else {
-                        texture = loadedTextures[texPath];
-                    }
+                std::ifstream f(mesh.texturePath.c_str());
+                if (!f.good()) {
+                    std::cerr << "Warning: Texture file not found: " << mesh.texturePath << std::endl;
                 }
+                f.close();
             }
 
-            if (!texture) {
-                std::cout << "Using default texture for shape in " << objPath << std::endl;
-                texture = std::make_shared<Texture>("../Textures/default.png");
+            if (data.textures.find(mesh.texturePath) == data.textures.end()) {
+                data.textures.emplace(mesh.texturePath,
+                    TextureData::load(mesh.texturePath.c_str()).reduced(TextureData::STREAMING_START_SIZE));
             }
 
-            meshes.push_back(std::make_shared<Mesh>(vertices, indices, texture));
+            data.meshes.push_back(std::move(mesh));
+        }
+
+        return data;
+    }
+};
+
+class Model {
+private:
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    std::vector<std::shared_ptr<Texture>> textures;
+    glm::vec3 position{ 0.0f };
+    glm::vec3 rotation{ 0.0f };
+    glm::vec3 scale{ 1.0f };
+    std::string name;
+    AABB localBounds;
+    bool exhibit = true;
+    bool occluder = false;
+    bool lightmapped = false;
+
+public:
+    Model(const char* objPath, const char* mtlBaseDir) : Model(ModelData::load(objPath, mtlBaseDir), objPath) {
+    }
+
+    // Uploads the parsed data; must run on the thread that owns the GL context. The GL
+    // objects are registered under owner, usually the model name.
+    Model(const ModelData& data, const std::string& owner = "unnamed model") : name(owner), localBounds(data.bounds) {
+        std::unordered_map<std::string, std::shared_ptr<Texture>> loadedTextures;
+        for (const auto& texture : data.textures) {
+            loadedTextures[texture.first] = std::make_shared<Texture>(texture.second, owner);
+            textures.push_back(loadedTextures[texture.first]);
+        }
+
+        for (const auto& mesh : data.meshes) {
+            meshes.push_back(std::make_shared<Mesh>(mesh.vertices, mesh.indices, loadedTextures[mesh.texturePath],
+                mesh.lightmapCoords, owner));
+        }
+        lightmapped = !meshes.empty() && std::all_of(meshes.begin(), meshes.end(),
+            [](const std::shared_ptr<Mesh>& mesh) { return mesh->hasLightmap(); });
+    }
+
+    void record(RenderCommandList& list) const {
+        for (const auto& mesh : meshes) {
+            mesh->record(list);
         }
     }
 
-    void draw(Shader& shader) {
+    size_t getMeshCount() const { return meshes.size(); }
+    const std::vector<std::shared_ptr<Texture>>& getTextures() const { return textures; }
+
+    size_t getTriangleCount() const {
+        size_t count = 0;
         for (const auto& mesh : meshes) {
-            mesh->draw(shader);
+            count += mesh->getTriangleCount();
         }
+        return count;
     }
 
     void setPosition(const glm::vec3& pos) { position = pos; }
@@ -107,9 +140,28 @@ public:
     void setScale(const glm::vec3& s) { scale = s; }
 
     void setName(const std::string& modelName) {  name = modelName;}
-    std::string getName() const { return name;}
+    const std::string& getName() const { return name;}
+
+    // Exhibits can be picked and block the camera; the museum shell is not an exhibit.
+    void setExhibit(bool value) { exhibit = value; }
+    bool isExhibit() const { return exhibit; }
+
+    // Occluders are rasterized into the occlusion buffer and never tested against it.
+    void setOccluder(bool value) { occluder = value; }
+    bool isOccluder() const { return occluder; }
+
+    // Lightmapped models are drawn with the baked lighting shader variant.
+    bool isLightmapped() const { return lightmapped; }
+
+    const AABB& getLocalBounds() const { return localBounds; }
+    AABB getWorldBounds(const glm::mat4& modelMatrix) const { return localBounds.transformed(modelMatrix); }
+    AABB getWorldBounds() const { return getWorldBounds(getModelMatrix()); }
 
     glm::mat4 getModelMatrix() const {
+        return composeMatrix(position, rotation, scale);
+    }
+
+    static glm::mat4 composeMatrix(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, position);
         model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
@@ -0,0 +1 @@
+#include "ObjParser.h"
\ No newline at end of file
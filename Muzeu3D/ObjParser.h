@@ -0,0 +1,717 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Bounds.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+
+// Wavefront OBJ/MTL reader that produces the interleaved layout Mesh uploads
+// (position, normal, texcoord; 8 floats per vertex, one vertex per face corner).
+//
+// The mapped file is cut into chunks at line boundaries. A first parallel pass
+// counts the v/vt/vn lines of every chunk, so each chunk knows where its attributes
+// land in the shared arrays and can resolve relative indices. The second pass parses
+// the chunks in parallel into those arrays plus per-chunk runs of triangulated face
+// corners; the runs are then joined into meshes (a new mesh starts at o/g/usemtl)
+// and written straight into the final vertex and index buffers.
+class ObjParser {
+public:
+    struct Mesh {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        std::string material;
+        std::string diffuseTexture;     // as written in the MTL file, empty if none
+    };
+
+    struct Result {
+        std::vector<Mesh> meshes;
+        AABB bounds;
+    };
+
+private:
+    static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+    struct Corner {
+        int position;
+        int texcoord;   // -1 if missing
+        int normal;     // -1 if missing
+    };
+
+    // A face with more than four corners, kept in Run::polygonCorners until it can be
+    // ear clipped; its triangles go before corners[insertAt].
+    struct Polygon {
+        size_t insertAt;
+        size_t first;
+        size_t count;
+    };
+
+    // Faces between two o/g/usemtl statements.
+    struct Run {
+        bool startsGroup = false;
+        bool setsMaterial = false;
+        std::string material;
+        std::vector<Corner> corners;    // three per triangle
+        std::vector<size_t> quads;      // first corner of quads split as (0 1 2)(0 2 3)
+        std::vector<Polygon> polygons;
+        std::vector<Corner> polygonCorners;
+        size_t outputOffset = 0;        // first corner in the destination mesh
+        int mesh = -1;
+    };
+
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        size_t positionCount = 0;
+        size_t texcoordCount = 0;
+        size_t normalCount = 0;
+        size_t positionOffset = 0;
+        size_t texcoordOffset = 0;
+        size_t normalOffset = 0;
+        std::vector<Run> runs;
+        std::vector<std::string> materialLibraries;
+        std::string error;
+    };
+
+    struct Attributes {
+        std::vector<float> positions;
+        std::vector<float> texcoords;
+        std::vector<float> normals;
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) p++;
+        return p;
+    }
+
+    static const char* lineEnd(const char* p, const char* end) {
+        while (p < end && *p != '\n' && *p != '\r') p++;
+        return p;
+    }
+
+    static const char* nextLine(const char* p, const char* end) {
+        p = lineEnd(p, end);
+        while (p < end && (*p == '\n' || *p == '\r')) p++;
+        return p;
+    }
+
+    static std::string trim(const char* begin, const char* end) {
+        begin = skipSpaces(begin, end);
+        while (end > begin && isSpace(end[-1])) end--;
+        return std::string(begin, end);
+    }
+
+    // Decimal float parser (sign, digits, fraction, exponent). Anything unusual such as
+    // "nan" or "inf" goes through strtod. Returns nullptr if there is no number.
+    static const char* parseFloat(const char* p, const char* end, float& value) {
+        static const double POWERS[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        p = skipSpaces(p, end);
+        const char* start = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        bool any = false;
+        while (p < end && isDigit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) digits++;
+            }
+            else {
+                exponent++;
+            }
+            any = true;
+            p++;
+        }
+        if (p < end && *p == '.') {
+            p++;
+            while (p < end && isDigit(*p)) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    if (mantissa) digits++;
+                    exponent--;
+                }
+                any = true;
+                p++;
+            }
+        }
+        if (!any) {
+            char buffer[64];
+            size_t length = std::min<size_t>(lineEnd(start, end) - start, sizeof(buffer) - 1);
+            std::copy(start, start + length, buffer);
+            buffer[length] = '\0';
+            char* parsedEnd = nullptr;
+            double parsed = std::strtod(buffer, &parsedEnd);
+            if (parsedEnd == buffer) return nullptr;
+            value = static_cast<float>(parsed);
+            return start + (parsedEnd - buffer);
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* exponentStart = p;
+            p++;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negativeExponent = *p == '-';
+                p++;
+            }
+            if (p < end && isDigit(*p)) {
+                int e = 0;
+                while (p < end && isDigit(*p)) {
+                    if (e < 10000) e = e * 10 + (*p - '0');
+                    p++;
+                }
+                exponent += negativeExponent ? -e : e;
+            }
+            else {
+                p = exponentStart;
+            }
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (exponent < 0) {
+            result = -exponent <= 22 ? result / POWERS[-exponent] : result * std::pow(10.0, exponent);
+        }
+        else if (exponent > 0) {
+            result = exponent <= 22 ? result * POWERS[exponent] : result * std::pow(10.0, exponent);
+        }
+        value = static_cast<float>(negative ? -result : result);
+        return p;
+    }
+
+    // Fails on values outside the range of int rather than wrapping into a valid index.
+    static const char* parseInt(const char* p, const char* end, int& value) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        if (p >= end || !isDigit(*p)) return nullptr;
+        long long result = 0;
+        while (p < end && isDigit(*p)) {
+            result = result * 10 + (*p - '0');
+            if (result > std::numeric_limits<int>::max()) return nullptr;
+            p++;
+        }
+        value = static_cast<int>(negative ? -result : result);
+        return p;
+    }
+
+    // OBJ indices are 1-based, negative ones count back from the last attribute read.
+    static bool resolveIndex(int index, size_t readSoFar, size_t total, int& resolved) {
+        long long value = index > 0 ? static_cast<long long>(index) - 1 : static_cast<long long>(readSoFar) + index;
+        if (index == 0 || value < 0 || value >= static_cast<long long>(total)) return false;
+        resolved = static_cast<int>(value);
+        return true;
+    }
+
+    static void countAttributes(Chunk& chunk) {
+        for (const char* p = chunk.begin; p < chunk.end; p = nextLine(p, chunk.end)) {
+            p = skipSpaces(p, chunk.end);
+            if (chunk.end - p < 2 || *p != 'v') continue;
+            if (isSpace(p[1])) chunk.positionCount++;
+            else if (p[1] == 't' && chunk.end - p > 2 && isSpace(p[2])) chunk.texcoordCount++;
+            else if (p[1] == 'n' && chunk.end - p > 2 && isSpace(p[2])) chunk.normalCount++;
+        }
+    }
+
+    static void parseChunk(Chunk& chunk, Attributes& attributes) {
+        size_t positionsRead = chunk.positionOffset;
+        size_t texcoordsRead = chunk.texcoordOffset;
+        size_t normalsRead = chunk.normalOffset;
+        size_t positionTotal = attributes.positions.size() / 3;
+        size_t texcoordTotal = attributes.texcoords.size() / 2;
+        size_t normalTotal = attributes.normals.size() / 3;
+
+        chunk.runs.emplace_back();
+        std::vector<Corner> polygon;
+
+        for (const char* p = chunk.begin; p < chunk.end; p = nextLine(p, chunk.end)) {
+            p = skipSpaces(p, chunk.end);
+            const char* end = lineEnd(p, chunk.end);
+            if (p >= end || *p == '#') continue;
+
+            const char* keyword = p;
+            while (p < end && !isSpace(*p)) p++;
+            size_t keywordLength = p - keyword;
+
+            if (keywordLength == 1 && keyword[0] == 'v') {
+                float* out = &attributes.positions[positionsRead * 3];
+                for (int i = 0; i < 3; i++) {
+                    if (!(p = parseFloat(p, end, out[i]))) {
+                        chunk.error = "malformed vertex";
+                        return;
+                    }
+                }
+                positionsRead++;
+            }
+            else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 't') {
+                float* out = &attributes.texcoords[texcoordsRead * 2];
+                if (!(p = parseFloat(p, end, out[0]))) {
+                    chunk.error = "malformed texture coordinate";
+                    return;
+                }
+                if (!parseFloat(p, end, out[1])) {
+                    out[1] = 0.0f;
+                }
+                texcoordsRead++;
+            }
+            else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 'n') {
+                float* out = &attributes.normals[normalsRead * 3];
+                for (int i = 0; i < 3; i++) {
+                    if (!(p = parseFloat(p, end, out[i]))) {
+                        chunk.error = "malformed normal";
+                        return;
+                    }
+                }
+                normalsRead++;
+            }
+            else if (keywordLength == 1 && keyword[0] == 'f') {
+                polygon.clear();
+                while ((p = skipSpaces(p, end)) < end) {
+                    Corner corner{ -1, -1, -1 };
+                    int index;
+                    if (!(p = parseInt(p, end, index)) ||
+                        !resolveIndex(index, positionsRead, positionTotal, corner.position)) {
+                        chunk.error = "invalid vertex index in face";
+                        return;
+                    }
+                    if (p < end && *p == '/') {
+                        p++;
+                        if (p < end && *p != '/') {
+                            if (!(p = parseInt(p, end, index)) ||
+                                !resolveIndex(index, texcoordsRead, texcoordTotal, corner.texcoord)) {
+                                chunk.error = "invalid texture coordinate index in face";
+                                return;
+                            }
+                        }
+                        if (p < end && *p == '/') {
+                            p++;
+                            if (!(p = parseInt(p, end, index)) ||
+                                !resolveIndex(index, normalsRead, normalTotal, corner.normal)) {
+                                chunk.error = "invalid normal index in face";
+                                return;
+                            }
+                        }
+                    }
+                    polygon.push_back(corner);
+                    while (p < end && !isSpace(*p)) p++;
+                }
+
+                // Quads get their diagonal picked and larger polygons are ear clipped
+                // once all positions are known.
+                Run& run = chunk.runs.back();
+                std::vector<Corner>& corners = run.corners;
+                if (polygon.size() > 4) {
+                    run.polygons.push_back(Polygon{ corners.size(), run.polygonCorners.size(), polygon.size() });
+                    run.polygonCorners.insert(run.polygonCorners.end(), polygon.begin(), polygon.end());
+                    continue;
+                }
+                if (polygon.size() == 4) {
+                    run.quads.push_back(corners.size());
+                }
+                for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                    corners.push_back(polygon[0]);
+                    corners.push_back(polygon[i]);
+                    corners.push_back(polygon[i + 1]);
+                }
+            }
+            else if (keywordLength == 1 && (keyword[0] == 'o' || keyword[0] == 'g')) {
+                chunk.runs.emplace_back();
+                chunk.runs.back().startsGroup = true;
+            }
+            else if (keywordLength == 6 && std::equal(keyword, keyword + 6, "usemtl")) {
+                chunk.runs.emplace_back();
+                chunk.runs.back().setsMaterial = true;
+                chunk.runs.back().material = trim(p, end);
+            }
+            else if (keywordLength == 6 && std::equal(keyword, keyword + 6, "mtllib")) {
+                chunk.materialLibraries.push_back(trim(p, end));
+            }
+        }
+    }
+
+    // Point in polygon test (W. Randolph Franklin), as used by tinyobjloader.
+    static bool isInsideTriangle(const float x[3], const float y[3], float testX, float testY) {
+        bool inside = false;
+        for (int i = 0, j = 2; i < 3; j = i++) {
+            if ((y[i] > testY) != (y[j] > testY) && testX < (x[j] - x[i]) * (testY - y[i]) / (y[j] - y[i]) + x[i]) {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+    // Ear clipping in the plane of the polygon's first corner, step for step the
+    // triangulation tinyobjloader used, so models keep the exact same triangles.
+    static void earClip(const Corner* polygon, size_t count, const Attributes& attributes, std::vector<Corner>& out) {
+        auto coordinate = [&attributes](const Corner& corner, int axis) {
+            return attributes.positions[corner.position * 3 + axis];
+        };
+
+        // Project along the dominant axis of the first non-degenerate corner.
+        int axes[2] = { 1, 2 };
+        for (size_t k = 0; k < count; k++) {
+            const Corner& a = polygon[k];
+            const Corner& b = polygon[(k + 1) % count];
+            const Corner& c = polygon[(k + 2) % count];
+            float e0[3], e1[3];
+            for (int axis = 0; axis < 3; axis++) {
+                e0[axis] = coordinate(b, axis) - coordinate(a, axis);
+                e1[axis] = coordinate(c, axis) - coordinate(b, axis);
+            }
+            float cx = std::fabs(e0[1] * e1[2] - e0[2] * e1[1]);
+            float cy = std::fabs(e0[2] * e1[0] - e0[0] * e1[2]);
+            float cz = std::fabs(e0[0] * e1[1] - e0[1] * e1[0]);
+            const float epsilon = std::numeric_limits<float>::epsilon();
+            if (cx > epsilon || cy > epsilon || cz > epsilon) {
+                if (!(cx > cy && cx > cz)) {
+                    axes[0] = 0;
+                    if (cz > cx && cz > cy) {
+                        axes[1] = 1;
+                    }
+                }
+                break;
+            }
+        }
+
+        std::vector<Corner> remaining(polygon, polygon + count);
+        size_t guess = 0;
+        size_t iterationsLeft = remaining.size();
+        size_t previousSize = remaining.size();
+        while (remaining.size() > 3 && iterationsLeft > 0) {
+            size_t size = remaining.size();
+            if (guess >= size) {
+                guess -= size;
+            }
+            if (previousSize != size) {
+                previousSize = size;
+                iterationsLeft = size;
+            }
+            else {
+                iterationsLeft--;
+            }
+
+            Corner ear[3];
+            float x[3], y[3];
+            for (int k = 0; k < 3; k++) {
+                ear[k] = remaining[(guess + k) % size];
+                x[k] = coordinate(ear[k], axes[0]);
+                y[k] = coordinate(ear[k], axes[1]);
+            }
+
+            float cross = (x[1] - x[0]) * (y[2] - y[1]) - (y[1] - y[0]) * (x[2] - x[1]);
+            float area = (x[0] * y[1] - y[0] * x[1]) * 0.5f;
+            if (cross * area < 0.0f) {
+                guess++;
+                continue;
+            }
+
+            bool overlap = false;
+            for (size_t other = 3; other < size && !overlap; other++) {
+                const Corner& corner = remaining[(guess + other) % size];
+                overlap = isInsideTriangle(x, y, coordinate(corner, axes[0]), coordinate(corner, axes[1]));
+            }
+            if (overlap) {
+                guess++;
+                continue;
+            }
+
+            out.insert(out.end(), ear, ear + 3);
+            remaining.erase(remaining.begin() + (guess + 1) % size);
+        }
+
+        if (remaining.size() == 3) {
+            out.insert(out.end(), remaining.begin(), remaining.end());
+        }
+    }
+
+    // Moves the ear clipped triangles of run.polygons into run.corners and shifts the
+    // quads recorded after them.
+    static void triangulatePolygons(Run& run, const Attributes& attributes) {
+        if (run.polygons.empty()) return;
+
+        std::vector<Corner> corners;
+        corners.reserve(run.corners.size() + run.polygonCorners.size() * 3);
+        size_t copied = 0;
+        size_t quad = 0;
+        for (const Polygon& polygon : run.polygons) {
+            for (; quad < run.quads.size() && run.quads[quad] < polygon.insertAt; quad++) {
+                run.quads[quad] += corners.size() - copied;
+            }
+            corners.insert(corners.end(), run.corners.begin() + copied, run.corners.begin() + polygon.insertAt);
+            copied = polygon.insertAt;
+            earClip(&run.polygonCorners[polygon.first], polygon.count, attributes, corners);
+        }
+        for (; quad < run.quads.size(); quad++) {
+            run.quads[quad] += corners.size() - copied;
+        }
+        corners.insert(corners.end(), run.corners.begin() + copied, run.corners.end());
+
+        run.corners.swap(corners);
+        std::vector<Polygon>().swap(run.polygons);
+        std::vector<Corner>().swap(run.polygonCorners);
+    }
+
+    // Returns the texture file of a map_Kd statement, skipping its options
+    // (e.g. "map_Kd -s 6 8 1 -bm 0.5 textures/wall.png").
+    static std::string parseTextureStatement(const char* p, const char* end) {
+        while ((p = skipSpaces(p, end)) < end && *p == '-') {
+            const char* option = p;
+            while (p < end && !isSpace(*p)) p++;
+            std::string name(option, p);
+
+            int maxArguments = 0;
+            if (name == "-o" || name == "-s" || name == "-t") maxArguments = 3;
+            else if (name == "-mm") maxArguments = 2;
+            else if (name == "-blendu" || name == "-blendv" || name == "-cc" || name == "-clamp" ||
+                name == "-imfchan" || name == "-type" || name == "-bm" || name == "-boost" || name == "-texres") maxArguments = 1;
+
+            for (int i = 0; i < maxArguments; i++) {
+                const char* argument = skipSpaces(p, end);
+                const char* argumentEnd = argument;
+                while (argumentEnd < end && !isSpace(*argumentEnd)) argumentEnd++;
+                bool numeric = false;
+                if (argument < argumentEnd) {
+                    float unused;
+                    const char* parsed = parseFloat(argument, argumentEnd, unused);
+                    numeric = parsed == argumentEnd;
+                }
+                // -o/-s/-t take one to three numbers; the others always take their argument.
+                if (maxArguments == 3 && !numeric) break;
+                p = argumentEnd;
+            }
+        }
+        return trim(p, end);
+    }
+
+    // A missing library is not fatal: its materials keep the default texture, as they
+    // did with tinyobjloader.
+    static void parseMaterialLibrary(const std::string& path, std::unordered_map<std::string, std::string>& diffuseTextures) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Warning: Material library not found: " << path << std::endl;
+            return;
+        }
+
+        std::string current;
+        std::string line;
+        while (std::getline(file, line)) {
+            const char* p = skipSpaces(line.data(), line.data() + line.size());
+            const char* end = line.data() + line.size();
+            if (!line.empty() && line.back() == '\r') end--;
+            const char* keyword = p;
+            while (p < end && !isSpace(*p)) p++;
+            std::string name(keyword, p);
+
+            if (name == "newmtl") {
+                current = trim(p, end);
+                diffuseTextures.emplace(current, std::string());
+            }
+            else if (name == "map_Kd" && !current.empty()) {
+                diffuseTextures[current] = parseTextureStatement(p, end);
+            }
+        }
+    }
+
+    static std::vector<Chunk> splitIntoChunks(const MappedFile& file, size_t chunkCount) {
+        std::vector<Chunk> chunks;
+        const char* begin = file.begin();
+        const char* end = file.end();
+        size_t target = file.getSize() / chunkCount + 1;
+        while (begin < end) {
+            const char* split = end - begin > static_cast<ptrdiff_t>(target) ? nextLine(begin + target, end) : end;
+            Chunk chunk;
+            chunk.begin = begin;
+            chunk.end = split;
+            chunks.push_back(std::move(chunk));
+            begin = split;
+        }
+        return chunks;
+    }
+
+    static void forEach(JobSystem* jobs, size_t count, const std::function<void(size_t)>& body) {
+        if (jobs && count > 1) {
+            jobs->parallelFor(count, 1, [&body](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) body(i);
+            });
+        }
+        else {
+            for (size_t i = 0; i < count; i++) body(i);
+        }
+    }
+
+public:
+    // Parses objPath; material libraries are looked up in mtlBaseDir. Chunks are
+    // parsed on jobs when given, otherwise on the calling thread.
+    static Result load(const std::string& objPath, const std::string& mtlBaseDir, JobSystem* jobs = nullptr) {
+        MappedFile file(objPath);
+
+        size_t chunkCount = std::max<size_t>(1, file.getSize() / MIN_CHUNK_SIZE);
+        if (jobs) {
+            chunkCount = std::min<size_t>(chunkCount, (jobs->getWorkerCount() + 1) * 4);
+        }
+        else {
+            chunkCount = 1;
+        }
+        std::vector<Chunk> chunks = splitIntoChunks(file, chunkCount);
+
+        forEach(jobs, chunks.size(), [&chunks](size_t i) { countAttributes(chunks[i]); });
+
+        Attributes attributes;
+        size_t positions = 0, texcoords = 0, normals = 0;
+        for (Chunk& chunk : chunks) {
+            chunk.positionOffset = positions;
+            chunk.texcoordOffset = texcoords;
+            chunk.normalOffset = normals;
+            positions += chunk.positionCount;
+            texcoords += chunk.texcoordCount;
+            normals += chunk.normalCount;
+        }
+        attributes.positions.resize(positions * 3);
+        attributes.texcoords.resize(texcoords * 2);
+        attributes.normals.resize(normals * 3);
+
+        forEach(jobs, chunks.size(), [&chunks, &attributes](size_t i) { parseChunk(chunks[i], attributes); });
+        for (const Chunk& chunk : chunks) {
+            if (!chunk.error.empty()) {
+                throw std::runtime_error(objPath + ": " + chunk.error);
+            }
+        }
+        forEach(jobs, chunks.size(), [&chunks, &attributes](size_t i) {
+            for (Run& run : chunks[i].runs) triangulatePolygons(run, attributes);
+        });
+
+        std::unordered_map<std::string, std::string> diffuseTextures;
+        for (const Chunk& chunk : chunks) {
+            for (const std::string& library : chunk.materialLibraries) {
+                parseMaterialLibrary(mtlBaseDir + library, diffuseTextures);
+            }
+        }
+
+        // Join the runs in file order; a mesh ends where the group or material changes.
+        Result result;
+        std::vector<Run*> runs;
+        std::string material;
+        bool groupStarted = true;
+        for (Chunk& chunk : chunks) {
+            for (Run& run : chunk.runs) {
+                if (run.setsMaterial && run.material != material) {
+                    material = run.material;
+                    groupStarted = true;
+                }
+                if (run.startsGroup) {
+                    groupStarted = true;
+                }
+                if (run.corners.empty()) continue;
+
+                if (groupStarted || result.meshes.empty()) {
+                    Mesh mesh;
+                    mesh.material = material;
+                    auto texture = diffuseTextures.find(material);
+                    if (texture != diffuseTextures.end()) {
+                        mesh.diffuseTexture = texture->second;
+                    }
+                    result.meshes.push_back(std::move(mesh));
+                    groupStarted = false;
+                }
+                Mesh& mesh = result.meshes.back();
+                run.mesh = static_cast<int>(result.meshes.size()) - 1;
+                run.outputOffset = mesh.indices.size();
+                mesh.indices.resize(mesh.indices.size() + run.corners.size());
+                runs.push_back(&run);
+            }
+        }
+        for (Mesh& mesh : result.meshes) {
+            mesh.vertices.resize(mesh.indices.size() * 8);
+        }
+
+        std::vector<AABB> runBounds(runs.size());
+        forEach(jobs, runs.size(), [&](size_t r) {
+            Run& run = *runs[r];
+            Mesh& mesh = result.meshes[run.mesh];
+
+            // Split along the shorter diagonal, the same choice tinyobjloader made.
+            for (size_t quad : run.quads) {
+                Corner* corners = &run.corners[quad];
+                Corner c0 = corners[0], c1 = corners[1], c2 = corners[2], c3 = corners[5];
+                auto position = [&attributes](const Corner& corner) {
+                    const float* p = &attributes.positions[corner.position * 3];
+                    return glm::vec3(p[0], p[1], p[2]);
+                };
+                glm::vec3 e02 = position(c2) - position(c0);
+                glm::vec3 e13 = position(c3) - position(c1);
+                if (glm::dot(e02, e02) >= glm::dot(e13, e13)) {
+                    corners[0] = c0; corners[1] = c1; corners[2] = c3;
+                    corners[3] = c1; corners[4] = c2; corners[5] = c3;
+                }
+            }
+
+            float* out = &mesh.vertices[run.outputOffset * 8];
+            unsigned int* indices = &mesh.indices[run.outputOffset];
+            AABB bounds;
+
+            for (size_t i = 0; i < run.corners.size(); i++) {
+                const Corner& corner = run.corners[i];
+                const float* position = &attributes.positions[corner.position * 3];
+                out[0] = position[0];
+                out[1] = position[1];
+                out[2] = position[2];
+                bounds.expand(glm::vec3(position[0], position[1], position[2]));
+
+                if (corner.normal >= 0) {
+                    const float* normal = &attributes.normals[corner.normal * 3];
+                    out[3] = normal[0];
+                    out[4] = normal[1];
+                    out[5] = normal[2];
+                }
+                else {
+                    out[3] = 0.0f;
+                    out[4] = 1.0f;
+                    out[5] = 0.0f;
+                }
+
+                if (corner.texcoord >= 0) {
+                    out[6] = attributes.texcoords[corner.texcoord * 2];
+                    out[7] = attributes.texcoords[corner.texcoord * 2 + 1];
+                }
+                else {
+                    out[6] = 0.0f;
+                    out[7] = 0.0f;
+                }
+
+                indices[i] = static_cast<unsigned int>(run.outputOffset + i);
+                out += 8;
+            }
+            runBounds[r] = bounds;
+        });
+
+        for (const AABB& bounds : runBounds) {
+            if (bounds.isValid()) {
+                result.bounds = AABB::merge(result.bounds, bounds);
+            }
+        }
+        return result;
+    }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "OcclusionBuffer.h"
\ No newline at end of file
@@ -0,0 +1,264 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Bounds.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MUZEU_OCCLUSION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Low resolution software depth buffer for occlusion culling. Occluder triangles are
+// rasterized on the CPU (four pixels at a time with SSE2), a max-depth hierarchy is
+// built on top and bounding boxes are then tested against it. Nothing here touches
+// GL, so it runs on the recording thread and can be measured on its own.
+class OcclusionBuffer {
+public:
+    static const int WIDTH = 256;
+    static const int HEIGHT = 128;
+
+private:
+    struct ScreenVertex {
+        float x, y, z;
+    };
+
+    // levels[0] is the rasterized depth, every next level keeps the farthest depth of
+    // the 2x2 texels below it.
+    std::vector<std::vector<float>> levels;
+    std::vector<int> levelWidths;
+    std::vector<int> levelHeights;
+    glm::mat4 viewProjection{ 1.0f };
+
+    ScreenVertex toScreen(const glm::vec4& clip) const {
+        float invW = 1.0f / clip.w;
+        return ScreenVertex{
+            (clip.x * invW * 0.5f + 0.5f) * WIDTH,
+            (clip.y * invW * 0.5f + 0.5f) * HEIGHT,
+            clip.z * invW * 0.5f + 0.5f
+        };
+    }
+
+    // Clips against the near plane (z >= -w) and rasterizes the resulting triangles.
+    void clipAndRasterize(const glm::vec4 clip[3]) {
+        glm::vec4 polygon[4];
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4& a = clip[i];
+            const glm::vec4& b = clip[(i + 1) % 3];
+            float da = a.z + a.w;
+            float db = b.z + b.w;
+            if (da >= 0.0f) {
+                polygon[count++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                polygon[count++] = a + (b - a) * (da / (da - db));
+            }
+        }
+        if (count < 3) {
+            return;
+        }
+
+        ScreenVertex v0 = toScreen(polygon[0]);
+        for (int i = 1; i + 1 < count; i++) {
+            rasterizeTriangle(v0, toScreen(polygon[i]), toScreen(polygon[i + 1]));
+        }
+    }
+
+    void rasterizeTriangle(ScreenVertex v0, ScreenVertex v1, ScreenVertex v2) {
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (std::fabs(area) < 1e-8f) {
+            return;
+        }
+        // Occluders are rendered double sided; make the winding counter-clockwise.
+        if (area < 0.0f) {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        int minX = std::max(0, static_cast<int>(std::floor(std::min(v0.x, std::min(v1.x, v2.x)))));
+        int maxX = std::min(WIDTH - 1, static_cast<int>(std::ceil(std::max(v0.x, std::max(v1.x, v2.x)))));
+        int minY = std::max(0, static_cast<int>(std::floor(std::min(v0.y, std::min(v1.y, v2.y)))));
+        int maxY = std::min(HEIGHT - 1, static_cast<int>(std::ceil(std::max(v0.y, std::max(v1.y, v2.y)))));
+        if (minX > maxX || minY > maxY) {
+            return;
+        }
+        minX &= ~3;
+
+        // Edge functions E(x, y) = A * x + B * y + C, positive inside.
+        auto edge = [](const ScreenVertex& a, const ScreenVertex& b, float& A, float& B, float& C) {
+            A = a.y - b.y;
+            B = b.x - a.x;
+            C = -(A * a.x + B * a.y);
+        };
+        float A0, B0, C0, A1, B1, C1, A2, B2, C2;
+        edge(v1, v2, A0, B0, C0);   // weight of v0
+        edge(v2, v0, A1, B1, C1);   // weight of v1
+        edge(v0, v1, A2, B2, C2);   // weight of v2
+
+        // Depth is linear in screen space: z = zA * x + zB * y + zC.
+        float invArea = 1.0f / area;
+        float dz1 = (v1.z - v0.z) * invArea;
+        float dz2 = (v2.z - v0.z) * invArea;
+        float zA = A1 * dz1 + A2 * dz2;
+        float zB = B1 * dz1 + B2 * dz2;
+        float zC = v0.z + C1 * dz1 + C2 * dz2;
+
+        std::vector<float>& depth = levels[0];
+
+#ifdef MUZEU_OCCLUSION_SSE2
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 e0Step = _mm_set1_ps(A0 * 4.0f);
+        const __m128 e1Step = _mm_set1_ps(A1 * 4.0f);
+        const __m128 e2Step = _mm_set1_ps(A2 * 4.0f);
+        const __m128 zStep = _mm_set1_ps(zA * 4.0f);
+
+        for (int y = minY; y <= maxY; y++) {
+            float py = y + 0.5f;
+            __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(minX)), offsets);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A0), px), _mm_set1_ps(B0 * py + C0));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A1), px), _mm_set1_ps(B1 * py + C1));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A2), px), _mm_set1_ps(B2 * py + C2));
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), px), _mm_set1_ps(zB * py + zC));
+
+            float* row = &depth[y * WIDTH];
+            for (int x = minX; x <= maxX; x += 4) {
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                    _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside)) {
+                    __m128 current = _mm_loadu_ps(row + x);
+                    __m128 nearer = _mm_min_ps(current, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+                }
+                e0 = _mm_add_ps(e0, e0Step);
+                e1 = _mm_add_ps(e1, e1Step);
+                e2 = _mm_add_ps(e2, e2Step);
+                z = _mm_add_ps(z, zStep);
+            }
+        }
+#else
+        for (int y = minY; y <= maxY; y++) {
+            float py = y + 0.5f;
+            float* row = &depth[y * WIDTH];
+            for (int x = minX; x <= maxX; x++) {
+                float px = x + 0.5f;
+                if (A0 * px + B0 * py + C0 >= 0.0f &&
+                    A1 * px + B1 * py + C1 >= 0.0f &&
+                    A2 * px + B2 * py + C2 >= 0.0f) {
+                    row[x] = std::min(row[x], zA * px + zB * py + zC);
+                }
+            }
+        }
+#endif
+    }
+
+public:
+    OcclusionBuffer() {
+        int width = WIDTH;
+        int height = HEIGHT;
+        while (true) {
+            levels.emplace_back(width * height, 1.0f);
+            levelWidths.push_back(width);
+            levelHeights.push_back(height);
+            if (width == 1 && height == 1) break;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+    }
+
+    void clear(const glm::mat4& viewProjection) {
+        this->viewProjection = viewProjection;
+        std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+    }
+
+    // triangles is a world space triangle list (three vertices per triangle).
+    void rasterize(const std::vector<glm::vec3>& triangles) {
+        for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+            glm::vec4 clip[3] = {
+                viewProjection * glm::vec4(triangles[i], 1.0f),
+                viewProjection * glm::vec4(triangles[i + 1], 1.0f),
+                viewProjection * glm::vec4(triangles[i + 2], 1.0f)
+            };
+            if (clip[0].z + clip[0].w < 0.0f && clip[1].z + clip[1].w < 0.0f && clip[2].z + clip[2].w < 0.0f) {
+                continue;
+            }
+            clipAndRasterize(clip);
+        }
+    }
+
+    void buildHierarchy() {
+        for (size_t level = 1; level < levels.size(); level++) {
+            const std::vector<float>& source = levels[level - 1];
+            std::vector<float>& target = levels[level];
+            int sourceWidth = levelWidths[level - 1];
+            int sourceHeight = levelHeights[level - 1];
+            int width = levelWidths[level];
+            int height = levelHeights[level];
+
+            for (int y = 0; y < height; y++) {
+                int y0 = std::min(y * 2, sourceHeight - 1);
+                int y1 = std::min(y * 2 + 1, sourceHeight - 1);
+                for (int x = 0; x < width; x++) {
+                    int x0 = std::min(x * 2, sourceWidth - 1);
+                    int x1 = std::min(x * 2 + 1, sourceWidth - 1);
+                    target[y * width + x] = std::max(
+                        std::max(source[y0 * sourceWidth + x0], source[y0 * sourceWidth + x1]),
+                        std::max(source[y1 * sourceWidth + x0], source[y1 * sourceWidth + x1]));
+                }
+            }
+        }
+    }
+
+    // Conservative: anything crossing the near plane or leaving the screen is visible.
+    bool isVisible(const AABB& box) const {
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+        float nearestZ = std::numeric_limits<float>::max();
+
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec3 point((corner & 1) ? box.max.x : box.min.x,
+                (corner & 2) ? box.max.y : box.min.y,
+                (corner & 4) ? box.max.z : box.min.z);
+            glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+            if (clip.z + clip.w <= 0.0f || clip.w <= 1e-5f) {
+                return true;
+            }
+            ScreenVertex screen = toScreen(clip);
+            minX = std::min(minX, screen.x);
+            minY = std::min(minY, screen.y);
+            maxX = std::max(maxX, screen.x);
+            maxY = std::max(maxY, screen.y);
+            nearestZ = std::min(nearestZ, screen.z);
+        }
+
+        if (maxX < 0.0f || maxY < 0.0f || minX >= WIDTH || minY >= HEIGHT) {
+            return true;
+        }
+        int x0 = std::max(0, static_cast<int>(minX));
+        int y0 = std::max(0, static_cast<int>(minY));
+        int x1 = std::min(WIDTH - 1, static_cast<int>(maxX));
+        int y1 = std::min(HEIGHT - 1, static_cast<int>(maxY));
+
+        // Pick the level where the box covers at most 2x2 texels.
+        size_t level = 0;
+        while (level + 1 < levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+            level++;
+        }
+
+        const std::vector<float>& depth = levels[level];
+        int width = levelWidths[level];
+        for (int y = y0 >> level; y <= (y1 >> level); y++) {
+            for (int x = x0 >> level; x <= (x1 >> level); x++) {
+                if (nearestZ <= depth[y * width + x]) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
\ No newline at end of file
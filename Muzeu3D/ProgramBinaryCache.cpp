@@ -0,0 +1 @@
+#include "ProgramBinaryCache.h"
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// On-disk cache of linked program binaries (glGetProgramBinary). Entries are keyed by
+// a hash of the shader sources, the permutation defines and the driver identity, so a
+// driver update or an edited shader simply misses and gets recompiled.
+class ProgramBinaryCache {
+private:
+    std::string directory;
+    std::string driverId;
+    bool supported = false;
+
+    static const uint32_t MAGIC = 0x4D5A5042; // "MZPB"
+
+public:
+    static uint64_t hash(const std::string& text, uint64_t seed = 14695981039346656037ull) {
+        uint64_t h = seed;
+        for (unsigned char c : text) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    ProgramBinaryCache(const std::string& directory) : directory(directory) {
+        supported = GLEW_ARB_get_program_binary || GLEW_VERSION_4_1;
+        if (!supported) {
+            std::cout << "Program binaries not supported, shaders will be compiled on every launch" << std::endl;
+            return;
+        }
+
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0;
+
+        const GLubyte* vendor = glGetString(GL_VENDOR);
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        const GLubyte* version = glGetString(GL_VERSION);
+        driverId = std::string(vendor ? reinterpret_cast<const char*>(vendor) : "") + "|" +
+            (renderer ? reinterpret_cast<const char*>(renderer) : "") + "|" +
+            (version ? reinterpret_cast<const char*>(version) : "");
+
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+    }
+
+    bool isSupported() const { return supported; }
+
+    std::string makeKey(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const {
+        uint64_t h = hash(driverId);
+        h = hash(vertexSource, h);
+        h = hash(fragmentSource, h);
+        h = hash(defines, h);
+
+        std::ostringstream key;
+        key << std::hex << h;
+        return key.str();
+    }
+
+    // Tries to create program from a cached binary. Returns false on a miss or if the
+    // driver rejects the binary, in which case the program must be compiled normally.
+    bool load(const std::string& key, GLuint program) const {
+        if (!supported) return false;
+
+        std::ifstream file(directory + key + ".bin", std::ios::binary);
+        if (!file) return false;
+
+        uint32_t magic = 0;
+        GLenum format = 0;
+        GLint length = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&format), sizeof(format));
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        if (!file || magic != MAGIC || length <= 0) return false;
+
+        std::vector<char> binary(length);
+        file.read(binary.data(), length);
+        if (!file) return false;
+
+        glProgramBinary(program, format, binary.data(), length);
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success == GL_TRUE;
+    }
+
+    void store(const std::string& key, GLuint program) const {
+        if (!supported) return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        std::ofstream file(directory + key + ".bin", std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Failed to write shader cache entry: " << directory << key << ".bin" << std::endl;
+            return;
+        }
+        uint32_t magic = MAGIC;
+        file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(binary.data(), length);
+    }
+};
\ No newline at end of file
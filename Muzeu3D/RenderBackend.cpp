@@ -0,0 +1 @@
+#include "RenderBackend.h"
\ No newline at end of file
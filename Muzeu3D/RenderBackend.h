@@ -0,0 +1,75 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+#include "RenderCommandList.h"
+
+// Replays a RenderCommandList on the thread that owns the GL context.
+class RenderBackend {
+private:
+    unsigned int currentProgram = 0;
+
+public:
+    void execute(const RenderCommandList& list) {
+        currentProgram = 0;
+
+        for (const RenderCommand& cmd : list.getCommands()) {
+            switch (cmd.type) {
+            case RenderCommandType::SetViewport: {
+                const glm::vec4& v = list.getVector(cmd.dataIndex);
+                glViewport(static_cast<GLint>(v.x), static_cast<GLint>(v.y),
+                    static_cast<GLsizei>(v.z), static_cast<GLsizei>(v.w));
+                break;
+            }
+            case RenderCommandType::BindFramebuffer:
+                glBindFramebuffer(GL_FRAMEBUFFER, cmd.handle);
+                break;
+            case RenderCommandType::Clear:
+                glClear(static_cast<GLbitfield>(cmd.count));
+                break;
+            case RenderCommandType::UseProgram:
+                if (cmd.handle != currentProgram) {
+                    glUseProgram(cmd.handle);
+                    currentProgram = cmd.handle;
+                }
+                break;
+            case RenderCommandType::SetInt:
+                glUniform1i(cmd.location, cmd.count);
+                break;
+            case RenderCommandType::SetFloat:
+                glUniform1f(cmd.location, cmd.value);
+                break;
+            case RenderCommandType::SetVec3:
+                glUniform3fv(cmd.location, 1, glm::value_ptr(list.getVector(cmd.dataIndex)));
+                break;
+            case RenderCommandType::SetMat4:
+                glUniformMatrix4fv(cmd.location, 1, GL_FALSE, glm::value_ptr(list.getMatrix(cmd.dataIndex)));
+                break;
+            case RenderCommandType::BindTexture:
+                glActiveTexture(GL_TEXTURE0 + cmd.location);
+                glBindTexture(GL_TEXTURE_2D, cmd.handle);
+                break;
+            case RenderCommandType::DrawIndexed:
+                glBindVertexArray(cmd.handle);
+                glDrawElements(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT, 0);
+                break;
+            case RenderCommandType::BlitFramebuffer: {
+                const glm::vec4& source = list.getVector(cmd.dataIndex);
+                const glm::vec4& destination = list.getVector(cmd.dataIndex + 1);
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, cmd.handle);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                glBlitFramebuffer(static_cast<GLint>(source.x), static_cast<GLint>(source.y),
+                    static_cast<GLint>(source.z), static_cast<GLint>(source.w),
+                    static_cast<GLint>(destination.x), static_cast<GLint>(destination.y),
+                    static_cast<GLint>(destination.z), static_cast<GLint>(destination.w),
+                    GL_COLOR_BUFFER_BIT, GL_LINEAR);
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                break;
+            }
+            case RenderCommandType::RunTask:
+                list.getTask(cmd.dataIndex)();
+                break;
+            }
+        }
+        glBindVertexArray(0);
+    }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "RenderCommandList.h"
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+enum class RenderCommandType : uint8_t {
+    SetViewport,
+    BindFramebuffer,
+    Clear,
+    UseProgram,
+    SetInt,
+    SetFloat,
+    SetVec3,
+    SetMat4,
+    BindTexture,
+    DrawIndexed,
+    BlitFramebuffer,
+    RunTask
+};
+
+// One recorded GL call. Field meaning depends on type; larger payloads (matrices,
+// vectors, tasks) live in the owning list's pools and are referenced by index.
+struct RenderCommand {
+    RenderCommandType type;
+    unsigned int handle = 0;    // program, framebuffer, texture or vertex array
+    int location = 0;           // uniform location or texture unit
+    int count = 0;              // index count, clear mask or int uniform value
+    uint32_t dataIndex = 0;     // index into matrices / vectors / tasks
+    float value = 0.0f;
+};
+
+// Plain-data list of the GL work for one frame. Recording does not touch GL, so a
+// list can be built on any thread and executed later by RenderBackend on the thread
+// that owns the context. reset() keeps the capacity, so steady-state recording does
+// not allocate.
+class RenderCommandList {
+private:
+    std::vector<RenderCommand> commands;
+    std::vector<glm::mat4> matrices;
+    std::vector<glm::vec4> vectors;
+    std::vector<std::function<void()>> tasks;
+    uint64_t frameIndex = 0;
+    bool present = false;
+
+    RenderCommand& push(RenderCommandType type) {
+        commands.emplace_back();
+        commands.back().type = type;
+        return commands.back();
+    }
+
+public:
+    void reset(uint64_t frame) {
+        commands.clear();
+        matrices.clear();
+        vectors.clear();
+        tasks.clear();
+        frameIndex = frame;
+        present = false;
+    }
+
+    void setViewport(int x, int y, int width, int height) {
+        RenderCommand& cmd = push(RenderCommandType::SetViewport);
+        cmd.dataIndex = static_cast<uint32_t>(vectors.size());
+        vectors.emplace_back(x, y, width, height);
+    }
+
+    void bindFramebuffer(unsigned int framebuffer) {
+        push(RenderCommandType::BindFramebuffer).handle = framebuffer;
+    }
+
+    void clear(unsigned int mask) {
+        push(RenderCommandType::Clear).count = static_cast<int>(mask);
+    }
+
+    void useProgram(unsigned int program) {
+        push(RenderCommandType::UseProgram).handle = program;
+    }
+
+    // Uniform setters silently drop location -1, like glUniform* does.
+    void setInt(int location, int value) {
+        if (location < 0) return;
+        RenderCommand& cmd = push(RenderCommandType::SetInt);
+        cmd.location = location;
+        cmd.count = value;
+    }
+
+    void setFloat(int location, float value) {
+        if (location < 0) return;
+        RenderCommand& cmd = push(RenderCommandType::SetFloat);
+        cmd.location = location;
+        cmd.value = value;
+    }
+
+    void setVec3(int location, const glm::vec3& value) {
+        if (location < 0) return;
+        RenderCommand& cmd = push(RenderCommandType::SetVec3);
+        cmd.location = location;
+        cmd.dataIndex = static_cast<uint32_t>(vectors.size());
+        vectors.emplace_back(value, 0.0f);
+    }
+
+    void setMat4(int location, const glm::mat4& value) {
+        if (location < 0) return;
+        RenderCommand& cmd = push(RenderCommandType::SetMat4);
+        cmd.location = location;
+        cmd.dataIndex = static_cast<uint32_t>(matrices.size());
+        matrices.push_back(value);
+    }
+
+    void bindTexture(int unit, unsigned int texture) {
+        RenderCommand& cmd = push(RenderCommandType::BindTexture);
+        cmd.location = unit;
+        cmd.handle = texture;
+    }
+
+    void drawIndexed(unsigned int vertexArray, int indexCount) {
+        RenderCommand& cmd = push(RenderCommandType::DrawIndexed);
+        cmd.handle = vertexArray;
+        cmd.count = indexCount;
+    }
+
+    // Copies (and scales, with linear filtering) the colour of a source rectangle
+    // of framebuffer into a destination rectangle of the default framebuffer.
+    void blitToDefault(unsigned int framebuffer, int sourceWidth, int sourceHeight, int width, int height) {
+        RenderCommand& cmd = push(RenderCommandType::BlitFramebuffer);
+        cmd.handle = framebuffer;
+        cmd.dataIndex = static_cast<uint32_t>(vectors.size());
+        vectors.emplace_back(0, 0, sourceWidth, sourceHeight);
+        vectors.emplace_back(0, 0, width, height);
+    }
+
+    // Arbitrary work that must run on the GL thread (uploads, deletes), in command order.
+    void runTask(std::function<void()> task) {
+        RenderCommand& cmd = push(RenderCommandType::RunTask);
+        cmd.dataIndex = static_cast<uint32_t>(tasks.size());
+        tasks.push_back(std::move(task));
+    }
+
+    void setPresent(bool value) { present = value; }
+    bool shouldPresent() const { return present; }
+    uint64_t getFrameIndex() const { return frameIndex; }
+    bool empty() const { return commands.empty(); }
+
+    const std::vector<RenderCommand>& getCommands() const { return commands; }
+    const glm::mat4& getMatrix(uint32_t index) const { return matrices[index]; }
+    const glm::vec4& getVector(uint32_t index) const { return vectors[index]; }
+    const std::function<void()>& getTask(uint32_t index) const { return tasks[index]; }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "RenderStats.h"
\ No newline at end of file
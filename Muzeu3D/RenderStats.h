@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+
+struct RenderStats {
+    uint64_t framesRendered = 0;
+    uint64_t framesSkipped = 0;
+    uint64_t shadowPassesRendered = 0;
+    uint64_t shadowPassesSkipped = 0;
+
+    uint64_t drawCallsSubmitted = 0;
+    uint64_t trianglesSubmitted = 0;
+    uint64_t drawCallsSaved = 0;
+    uint64_t trianglesSaved = 0;
+    uint64_t objectsFrustumCulled = 0;
+    uint64_t objectsOcclusionCulled = 0;
+
+    uint64_t occlusionPasses = 0;
+    double occlusionSeconds = 0.0;
+    uint64_t lastOccludedObjects = 0;
+    double lastOcclusionMilliseconds = 0.0;
+
+    uint64_t modelsStreamedIn = 0;
+    uint64_t modelsEvicted = 0;
+    uint64_t modelsRejected = 0;
+    size_t residentModelBytes = 0;
+
+    uint64_t textureLevelsStreamedIn = 0;
+    uint64_t textureLevelsEvicted = 0;
+    size_t streamedTextureBytes = 0;
+
+    uint64_t resolutionChanges = 0;
+    float lastResolutionScale = 1.0f;
+    double lastGpuMilliseconds = 0.0;
+
+    // Frames after warm-up that streamed nothing and should not have touched the heap.
+    uint64_t steadyFramesChecked = 0;
+    uint64_t steadyFramesAllocating = 0;
+    uint64_t lastFrameAllocations = 0;
+    size_t frameArenaPeakBytes = 0;
+
+    // Cost of the last full pass, used to estimate the work a skipped pass would have done.
+    uint64_t lastShadowPassDraws = 0;
+    uint64_t lastShadowPassTriangles = 0;
+    uint64_t lastMainPassDraws = 0;
+    uint64_t lastMainPassTriangles = 0;
+
+    void skipShadowPass() {
+        shadowPassesSkipped++;
+        drawCallsSaved += lastShadowPassDraws;
+        trianglesSaved += lastShadowPassTriangles;
+    }
+
+    void skipFrame() {
+        framesSkipped++;
+        drawCallsSaved += lastShadowPassDraws + lastMainPassDraws;
+        trianglesSaved += lastShadowPassTriangles + lastMainPassTriangles;
+    }
+
+    void print(std::ostream& out) const {
+        uint64_t frames = framesRendered + framesSkipped;
+        double skippedPercent = frames ? 100.0 * framesSkipped / frames : 0.0;
+        uint64_t totalTriangles = trianglesSubmitted + trianglesSaved;
+        double savedPercent = totalTriangles ? 100.0 * trianglesSaved / totalTriangles : 0.0;
+
+        out << "[RenderStats] frames rendered: " << framesRendered
+            << ", skipped: " << framesSkipped << " (" << skippedPercent << "%)\n"
+            << "[RenderStats] shadow passes rendered: " << shadowPassesRendered
+            << ", skipped: " << shadowPassesSkipped << "\n"
+            << "[RenderStats] draw calls submitted: " << drawCallsSubmitted
+            << ", saved: " << drawCallsSaved << "\n"
+            << "[RenderStats] objects frustum culled: " << objectsFrustumCulled << "\n"
+            << "[RenderStats] objects occlusion culled: " << objectsOcclusionCulled
+            << " (last frame: " << lastOccludedObjects << ")\n"
+            << "[RenderStats] occlusion culling: "
+            << (occlusionPasses ? 1000.0 * occlusionSeconds / occlusionPasses : 0.0) << " ms avg, "
+            << lastOcclusionMilliseconds << " ms last frame\n"
+            << "[RenderStats] models streamed in: " << modelsStreamedIn
+            << ", evicted: " << modelsEvicted << ", over budget: " << modelsRejected
+            << ", resident: " << residentModelBytes / (1024 * 1024) << " MB\n"
+            << "[RenderStats] texture mip loads: " << textureLevelsStreamedIn
+            << ", evictions: " << textureLevelsEvicted
+            << ", resident: " << streamedTextureBytes / (1024 * 1024) << " MB\n"
+            << "[RenderStats] resolution scale: " << lastResolutionScale
+            << " (changed " << resolutionChanges << " times), GPU main pass: " << lastGpuMilliseconds << " ms\n"
+            << "[RenderStats] steady frames allocating: " << steadyFramesAllocating << " of " << steadyFramesChecked
+            << " (last frame: " << lastFrameAllocations << " allocations), frame arena peak: "
+            << frameArenaPeakBytes / 1024 << " KB\n"
+            << "[RenderStats] triangles submitted: " << trianglesSubmitted
+            << ", saved: " << trianglesSaved << " (" << savedPercent << "% of GPU geometry work)\n";
+    }
+};
\ No newline at end of file
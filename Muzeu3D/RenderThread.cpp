@@ -0,0 +1 @@
+#include "RenderThread.h"
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <thread>
+#include "AllocationCounter.h"
+#include "FramePipeline.h"
+#include "RenderBackend.h"
+
+// Dedicated GL submission thread. Takes over the window's context on start() and
+// gives it back (not current anywhere) on stop(), so the caller can make it current
+// again for teardown.
+class RenderThread {
+private:
+    GLFWwindow* window = nullptr;
+    FramePipeline& pipeline;
+    RenderBackend backend;
+    std::thread thread;
+    std::atomic<uint64_t> allocations{ 0 };
+
+    void run() {
+        glfwMakeContextCurrent(window);
+
+        while (RenderCommandList* list = pipeline.beginExecution()) {
+            uint64_t before = AllocationCounter::threadAllocations();
+            backend.execute(*list);
+            if (list->shouldPresent()) {
+                glfwSwapBuffers(window);
+            }
+            allocations += AllocationCounter::threadAllocations() - before;
+            pipeline.endExecution(list);
+        }
+
+        glFinish();
+        glfwMakeContextCurrent(nullptr);
+    }
+
+public:
+    RenderThread(GLFWwindow* window, FramePipeline& pipeline)
+        : window(window), pipeline(pipeline) {
+    }
+
+    ~RenderThread() {
+        stop();
+    }
+
+    void start() {
+        glfwMakeContextCurrent(nullptr);
+        thread = std::thread(&RenderThread::run, this);
+    }
+
+    // Heap allocations made while submitting lists since the last call.
+    uint64_t takeAllocations() {
+        return allocations.exchange(0);
+    }
+
+    void stop() {
+        if (thread.joinable()) {
+            pipeline.stop();
+            thread.join();
+        }
+    }
+};
\ No newline at end of file
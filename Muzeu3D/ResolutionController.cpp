@@ -0,0 +1 @@
+#include "ResolutionController.h"
\ No newline at end of file
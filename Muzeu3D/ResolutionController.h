@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+struct ResolutionControllerSettings {
+    double targetMilliseconds = 1000.0 / 60.0;  // GPU time per frame to aim for
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f;            // scales are multiples of this
+    int maxGrowSteps = 2;               // grow slowly, shrink as far as needed at once
+    double headroom = 0.85;             // only grow while the prediction stays under this share of the target
+    double smoothing = 0.25;            // weight of a new sample in the running average
+    int settleFrames = 6;               // samples ignored after a change, they may predate it
+};
+
+// Picks the render scale (per axis) from measured GPU frame times. GPU cost is assumed
+// to grow with the pixel count, so the scale that would hit the target is
+// scale * sqrt(target / time). Pure logic without GL, so timing traces can be fed to
+// it directly.
+class ResolutionController {
+private:
+    ResolutionControllerSettings settings;
+    float scale;
+    double average = 0.0;
+    int samples = 0;
+    int settle = 0;
+
+    float quantize(float value) const {
+        float steps = std::floor(value / settings.scaleStep + 1e-4f);
+        return std::min(settings.maxScale, std::max(settings.minScale, steps * settings.scaleStep));
+    }
+
+public:
+    ResolutionController(const ResolutionControllerSettings& settings = ResolutionControllerSettings())
+        : settings(settings), scale(settings.maxScale) {
+    }
+
+    // Feeds one GPU frame time; returns true when the scale changed.
+    bool addSample(double milliseconds) {
+        if (milliseconds <= 0.0) return false;
+        if (settle > 0) {
+            settle--;
+            return false;
+        }
+
+        average = samples == 0 ? milliseconds : average + (milliseconds - average) * settings.smoothing;
+        samples++;
+
+        float next = scale;
+        if (average > settings.targetMilliseconds) {
+            next = quantize(scale * static_cast<float>(std::sqrt(settings.targetMilliseconds * settings.headroom / average)));
+        }
+        else {
+            float ideal = scale * static_cast<float>(std::sqrt(settings.targetMilliseconds * settings.headroom / average));
+            float limit = scale + settings.maxGrowSteps * settings.scaleStep;
+            next = std::max(scale, quantize(std::min(ideal, limit)));
+        }
+        if (next == scale) return false;
+
+        scale = next;
+        average = 0.0;
+        samples = 0;
+        settle = settings.settleFrames;
+        return true;
+    }
+
+    void reset() {
+        scale = settings.maxScale;
+        average = 0.0;
+        samples = 0;
+        settle = 0;
+    }
+
+    // True while the samples after a change are being skipped; they only arrive if
+    // frames keep being rendered.
+    bool isSettling() const { return settle > 0; }
+    float getScale() const { return scale; }
+    double getAverageMilliseconds() const { return average; }
+    const ResolutionControllerSettings& getSettings() const { return settings; }
+};
\ No newline at end of file
@@ -0,0 +1 @@
+#include "ResourceRegistry.h"
\ No newline at end of file
@@ -0,0 +1,213 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class ResourceCategory {
+    // GL objects; sizes are estimates from dimensions and formats
+    Geometry,           // vertex arrays, vertex and index buffers
+    Texture,            // material textures with mips
+    Lightmap,
+    ShadowMap,
+    RenderTarget,       // framebuffers and offscreen colour/depth buffers
+    // CPU memory held on behalf of assets
+    StagingData,        // parsed models waiting for their upload
+    Occluders,          // world space triangles for occlusion culling
+    BakedData,          // lightmap coordinates and probes
+    Count
+};
+
+// Process-wide ledger of GL objects and CPU asset memory by category and owner, with
+// live totals, peaks and optional GPU/CPU budgets. Owners are model names or the
+// subsystem that holds the resource. Every resource is tracked where it is created
+// and released where it is destroyed, so whatever is left at exit has leaked.
+//
+// Thread safe: models are uploaded and deleted on the render thread.
+class ResourceRegistry {
+private:
+    struct Entry {
+        ResourceCategory category;
+        std::string owner;
+        size_t bytes;
+    };
+
+    static const size_t CATEGORY_COUNT = static_cast<size_t>(ResourceCategory::Count);
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t nextId = 1;
+
+    size_t bytes[CATEGORY_COUNT] = {};
+    size_t peakBytes[CATEGORY_COUNT] = {};
+    size_t objects[CATEGORY_COUNT] = {};
+    size_t gpuBytes = 0, cpuBytes = 0;
+    size_t gpuPeak = 0, cpuPeak = 0;
+
+    size_t gpuBudget = 0, cpuBudget = 0;     // 0 = unlimited
+    bool gpuOverBudget = false, cpuOverBudget = false;
+    uint64_t budgetOverruns = 0;
+
+    static size_t index(ResourceCategory category) { return static_cast<size_t>(category); }
+    static double megabytes(size_t value) { return value / (1024.0 * 1024.0); }
+
+    // Warns once per overrun; the flag clears when usage drops back under the budget.
+    void checkBudget(const char* kind, size_t used, size_t budget, bool& over) {
+        bool exceeded = budget && used > budget;
+        if (exceeded && !over) {
+            budgetOverruns++;
+            std::cerr << "Warning: " << kind << " memory " << megabytes(used) << " MB exceeds its budget of "
+                << megabytes(budget) << " MB\n";
+        }
+        over = exceeded;
+    }
+
+    void add(ResourceCategory category, long long delta) {
+        size_t i = index(category);
+        bytes[i] += delta;
+        peakBytes[i] = std::max(peakBytes[i], bytes[i]);
+        if (isGpu(category)) {
+            gpuBytes += delta;
+            gpuPeak = std::max(gpuPeak, gpuBytes);
+            checkBudget("GPU", gpuBytes, gpuBudget, gpuOverBudget);
+        }
+        else {
+            cpuBytes += delta;
+            cpuPeak = std::max(cpuPeak, cpuBytes);
+            checkBudget("CPU", cpuBytes, cpuBudget, cpuOverBudget);
+        }
+    }
+
+public:
+    static ResourceRegistry& global() {
+        static ResourceRegistry registry;
+        return registry;
+    }
+
+    static bool isGpu(ResourceCategory category) { return category < ResourceCategory::StagingData; }
+
+    static const char* categoryName(ResourceCategory category) {
+        static const char* const NAMES[CATEGORY_COUNT] = {
+            "geometry", "textures", "lightmap", "shadow maps", "render targets",
+            "staging data", "occluders", "baked data"
+        };
+        return NAMES[index(category)];
+    }
+
+    // Returns the id to release the resource with; 0 is never handed out.
+    uint64_t track(ResourceCategory category, const std::string& owner, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t id = nextId++;
+        entries.emplace(id, Entry{ category, owner, size });
+        objects[index(category)]++;
+        add(category, static_cast<long long>(size));
+        return id;
+    }
+
+    // Releasing id 0 does nothing, so untracked members can be released unconditionally.
+    void release(uint64_t id) {
+        if (id == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        objects[index(it->second.category)]--;
+        add(it->second.category, -static_cast<long long>(it->second.bytes));
+        entries.erase(it);
+    }
+
+    // For resources that grow or shrink in place, like textures streaming mip levels.
+    void resize(uint64_t id, size_t size) {
+        if (id == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        add(it->second.category, static_cast<long long>(size) - static_cast<long long>(it->second.bytes));
+        it->second.bytes = size;
+    }
+
+    void setBudgets(size_t gpu, size_t cpu) {
+        std::lock_guard<std::mutex> lock(mutex);
+        gpuBudget = gpu;
+        cpuBudget = cpu;
+        checkBudget("GPU", gpuBytes, gpuBudget, gpuOverBudget);
+        checkBudget("CPU", cpuBytes, cpuBudget, cpuOverBudget);
+    }
+
+    bool isGpuOverBudget() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return gpuOverBudget;
+    }
+
+    bool isCpuOverBudget() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cpuOverBudget;
+    }
+
+    size_t getBytes(ResourceCategory category) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes[index(category)];
+    }
+
+    size_t getGpuBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return gpuBytes;
+    }
+
+    size_t getCpuBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cpuBytes;
+    }
+
+    size_t getObjectCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    // Totals and peaks per category, then the owners holding the most memory.
+    void dump(std::ostream& out, size_t topOwners = 10) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        out << std::fixed << std::setprecision(1);
+        out << "[Resources] GPU: " << megabytes(gpuBytes) << " MB (peak " << megabytes(gpuPeak) << " MB";
+        if (gpuBudget) out << ", budget " << megabytes(gpuBudget) << " MB";
+        out << "), CPU: " << megabytes(cpuBytes) << " MB (peak " << megabytes(cpuPeak) << " MB";
+        if (cpuBudget) out << ", budget " << megabytes(cpuBudget) << " MB";
+        out << "), budget overruns: " << budgetOverruns << "\n";
+
+        for (size_t i = 0; i < CATEGORY_COUNT; i++) {
+            ResourceCategory category = static_cast<ResourceCategory>(i);
+            out << "[Resources]   " << (isGpu(category) ? "GPU " : "CPU ") << categoryName(category) << ": "
+                << objects[i] << " objects, " << megabytes(bytes[i]) << " MB (peak " << megabytes(peakBytes[i]) << " MB)\n";
+        }
+
+        std::unordered_map<std::string, std::pair<size_t, size_t>> owners;     // GPU, CPU bytes
+        for (const auto& entry : entries) {
+            auto& total = owners[entry.second.owner];
+            (isGpu(entry.second.category) ? total.first : total.second) += entry.second.bytes;
+        }
+        std::vector<std::pair<std::string, std::pair<size_t, size_t>>> sorted(owners.begin(), owners.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return a.second.first + a.second.second > b.second.first + b.second.second;
+        });
+        if (sorted.size() > topOwners) sorted.resize(topOwners);
+        for (const auto& owner : sorted) {
+            out << "[Resources]   " << owner.first << ": GPU " << megabytes(owner.second.first)
+                << " MB, CPU " << megabytes(owner.second.second) << " MB\n";
+        }
+        out << std::defaultfloat << std::setprecision(6);
+    }
+
+    // Lists whatever is still tracked; meant for after every owner has been destroyed.
+    bool reportLeaks(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : entries) {
+            out << "[Resources] leaked " << categoryName(entry.second.category) << " of "
+                << entry.second.owner << " (" << entry.second.bytes << " bytes)\n";
+        }
+        return !entries.empty();
+    }
+};
\ No newline at end of file
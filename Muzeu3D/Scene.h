@@ -4,74 +4,173 @@
 #include "Model.h"
 #include "Camera.h"
 #include "Shader.h"
+#include "ShaderLibrary.h"
 #include "Light.h"
+#include "RenderStats.h"
+#include "JobSystem.h"
+#include "BVH.h"
+#include "OcclusionBuffer.h"
+#include "SceneDescription.h"
+#include "StreamingManager.h"
+#include "TextureStreamer.h"
+#include "BakedLighting.h"
+#include "DynamicResolution.h"
+#include "ResourceRegistry.h"
+#include "FrameArena.h"
+#include <chrono>
+#include <fstream>
 
 class Scene {
+public:
+    enum DirtyFlags : unsigned int {
+        DIRTY_NONE = 0,
+        DIRTY_CAMERA = 1 << 0,
+        DIRTY_LIGHTS = 1 << 1,
+        DIRTY_MODELS = 1 << 2,
+        DIRTY_SETTINGS = 1 << 3,
+        DIRTY_ALL = DIRTY_CAMERA | DIRTY_LIGHTS | DIRTY_MODELS | DIRTY_SETTINGS
+    };
+
 private:
+    JobSystem& jobs;
+    SceneDescription description;
+    std::unique_ptr<BakedLighting> bakedLighting;
+    ShaderLibrary shaderLibrary;
     std::vector<std::shared_ptr<Model>> models;
+    std::vector<glm::mat4> modelMatrices;
+
+    BVH bvh;
+    std::vector<int> modelProxies;
+    std::vector<size_t> animatedModels;
+    std::vector<char> visibleModels;
+
+    // Occluders are static, so the triangles of the resident ones are kept in world space.
+    OcclusionBuffer occlusionBuffer;
+    std::vector<glm::vec3> occluderTriangles;
+    bool occlusionCulling = true;
+    const float CAMERA_RADIUS = 0.25f;
     std::unique_ptr<Camera> camera;
-    std::unique_ptr<Shader> shader;
-    std::unique_ptr<Shader> lightIndicatorShader;
-    unsigned int lightVAO, lightVBO;
+    const int PCF_RADIUS = 1;
+    Shader* litShader = nullptr;
+    Shader* unlitShader = nullptr;
+    Shader* lightIndicatorShader = nullptr;
+    // Only requested when the scene has baked lighting.
+    Shader* bakedShader = nullptr;
+    Shader* probeLitShader = nullptr;
     glm::mat4 projection;
 
 
-    Light light1;
-    Light light2;
-    Light light3;
+    // The lit shader variant handles up to three lights.
+    static const size_t MAX_LIGHTS = 3;
+    std::vector<Light> lights;
 
     bool lightEnabled = true;
+    bool animationsPaused = false;
+
+    // Static geometry samples the lightmap atlas, everything else adds the indirect
+    // light of the probes around its centre.
+    static const int LIGHTMAP_UNIT = 4;
+    GLuint lightmapTexture = 0;
+    std::vector<BakedLighting::AmbientCube> modelProbes;
+    bool bakedLightingEnabled = true;
+
+    // Locations of the uniforms set every frame, resolved once per shader after the
+    // compiles finish, so recording neither builds names nor hashes strings.
+    struct SceneUniforms {
+        struct LightUniforms {
+            GLint position, ambient, diffuse, specular, constant, linear, quadratic;
+        };
+
+        GLint projection, view, viewPos, model;
+        GLint lightSpaceMatrix;             // shadow pass
+        GLint lightmap;
+        GLint shadowMaps[MAX_LIGHTS];
+        GLint lightSpaceMatrices[MAX_LIGHTS];
+        LightUniforms lights[MAX_LIGHTS];
+        GLint ambientCube[6];
+
+        // shader may be null (a variant the scene did not request); everything is -1 then.
+        static SceneUniforms resolve(const Shader* shader) {
+            auto location = [shader](const std::string& name) {
+                return shader ? shader->getUniformLocation(name) : -1;
+            };
+            SceneUniforms uniforms;
+            uniforms.projection = location("projection");
+            uniforms.view = location("view");
+            uniforms.viewPos = location("viewPos");
+            uniforms.model = location("model");
+            uniforms.lightSpaceMatrix = location("lightSpaceMatrix");
+            uniforms.lightmap = location("lightmap");
+            for (size_t i = 0; i < MAX_LIGHTS; i++) {
+                std::string number = std::to_string(i + 1);
+                uniforms.shadowMaps[i] = location("shadowMap" + number);
+                uniforms.lightSpaceMatrices[i] = location("lightSpaceMatrix" + number);
+
+                std::string prefix = "light" + number;
+                LightUniforms& light = uniforms.lights[i];
+                light.position = location(prefix + ".position");
+                light.ambient = location(prefix + ".ambient");
+                light.diffuse = location(prefix + ".diffuse");
+                light.specular = location(prefix + ".specular");
+                light.constant = location(prefix + ".constant");
+                light.linear = location(prefix + ".linear");
+                light.quadratic = location(prefix + ".quadratic");
+            }
+            for (int face = 0; face < 6; face++) {
+                uniforms.ambientCube[face] = location("ambientCube[" + std::to_string(face) + "]");
+            }
+            return uniforms;
+        }
+    };
+
+    SceneUniforms litUniforms;
+    SceneUniforms unlitUniforms;
+    SceneUniforms bakedUniforms;
+    SceneUniforms probeLitUniforms;
+    SceneUniforms shadowMapUniforms;
+
+    // Transient per-frame data (draw lists) lives here and is dropped when a frame is
+    // recorded. Steady-state frames must not touch the heap: after warm-up, frames that
+    // stream nothing are checked against the allocation counter.
+    FrameArena frameArena;
+    static const uint64_t ALLOCATION_WARMUP_FRAMES = 120;
+    static const int ALLOCATION_QUIET_FRAMES = 3;     // lets the render thread drain streaming work
+    int quietFrames = 0;
+    bool allocationWarningShown = false;
+
+    unsigned int dirtyFlags = DIRTY_ALL;
+    RenderStats stats;
+    StreamingManager streaming;
+    TextureStreamer textureStreamer;
 
     struct ShadowMap {
         unsigned int depthMapFBO;
         unsigned int depthMap;
         glm::mat4 lightSpaceMatrix;
+        uint64_t resourceIds[2];
     };
     std::vector<ShadowMap> shadowMaps;
 
-    void setupLights() {
-        light1 = Light(
-            glm::vec3(5.0f, 4.0f, 5.0f),      
-            glm::vec3(0.2f, 0.15f, 0.1f),       
-            glm::vec3(0.8f, 0.6f, 0.4f),        
-            glm::vec3(1.0f, 0.8f, 0.6f),      
-            1.0f, 0.07f, 0.017f                  
-        );
-
-        light2 = Light(
-            glm::vec3(-4.6f, 4.0f, -4.5f),     
-            glm::vec3(0.1f, 0.15f, 0.2f),       
-            glm::vec3(0.4f, 0.6f, 0.8f),        
-            glm::vec3(0.6f, 0.8f, 1.0f),        
-            1.0f, 0.09f, 0.032f                 
-        );
-
-
-        light3 = Light(
-            glm::vec3(0.0f, 4.0f, 0.0f),        
-            glm::vec3(0.15f),                 
-            glm::vec3(0.7f),              
-            glm::vec3(0.9f),                 
-            1.0f, 0.045f, 0.0075f                
-        );
-    }
-
-    unsigned int depthMapFBO;
-    unsigned int depthMap;
     const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    // Independent of the window so 4K kiosks do not pay for 4K shadow maps.
+    const int SHADOW_MAP_SIZE = 2048;
+
+    // The main pass renders at a scale picked from measured GPU frame times.
+    std::unique_ptr<DynamicResolution> dynamicResolution;
 
-    std::unique_ptr<Shader> shadowMapShader;
-    glm::mat4 lightSpaceMatrix;
+    Shader* shadowMapShader = nullptr;
+    uint64_t lightmapResourceId = 0;
+    uint64_t bakedResourceId = 0;
 
     void initShadowMaps() {
-        shadowMaps.resize(3); 
+        shadowMaps.resize(lights.size());
 
         for (auto& shadowMap : shadowMaps) {
             glGenFramebuffers(1, &shadowMap.depthMapFBO);
             glGenTextures(1, &shadowMap.depthMap);
             glBindTexture(GL_TEXTURE_2D, shadowMap.depthMap);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
-                mode->width, mode->height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+                SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -84,13 +183,20 @@ private:
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowMap.depthMap, 0);
             glDrawBuffer(GL_NONE);
             glReadBuffer(GL_NONE);
+
+            ResourceRegistry& registry = ResourceRegistry::global();
+            shadowMap.resourceIds[0] = registry.track(ResourceCategory::ShadowMap, "Scene",
+                static_cast<size_t>(SHADOW_MAP_SIZE) * SHADOW_MAP_SIZE * 4);
+            shadowMap.resourceIds[1] = registry.track(ResourceCategory::ShadowMap, "Scene", 0);
         }
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
-    void renderShadowMaps() {
-        std::vector<Light> lights = { light1, light2, light3 };
-        glViewport(0, 0, mode->width, mode->height);
+    void recordShadowMaps(RenderCommandList& list) {
+        list.setViewport(0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
+        list.useProgram(shadowMapShader->getProgram());
+        uint64_t draws = 0;
+        uint64_t triangles = 0;
 
         for (size_t i = 0; i < lights.size(); i++) {
             glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 1.0f, 7.5f);
@@ -100,310 +206,553 @@ private:
                 glm::vec3(0.0f, 1.0f, 0.0f));
             shadowMaps[i].lightSpaceMatrix = lightProjection * lightView;
 
-            shadowMapShader->use();
-            shadowMapShader->setMat4("lightSpaceMatrix", shadowMaps[i].lightSpaceMatrix);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, shadowMaps[i].depthMapFBO);
-            glClear(GL_DEPTH_BUFFER_BIT);
-
-            for (const auto& model : models) {
-                shadowMapShader->setMat4("model", model->getModelMatrix());
-                model->draw(*shadowMapShader);
+            list.setMat4(shadowMapUniforms.lightSpaceMatrix, shadowMaps[i].lightSpaceMatrix);
+            list.bindFramebuffer(shadowMaps[i].depthMapFBO);
+            list.clear(GL_DEPTH_BUFFER_BIT);
+
+            stats.objectsFrustumCulled += cullModels(shadowMaps[i].lightSpaceMatrix);
+            for (uint32_t m : collectVisibleModels()) {
+                const auto& model = models[m];
+                list.setMat4(shadowMapUniforms.model, modelMatrices[m]);
+                model->record(list);
+                draws += model->getMeshCount();
+                triangles += model->getTriangleCount();
             }
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        list.bindFramebuffer(0);
+
+        stats.shadowPassesRendered++;
+        stats.lastShadowPassDraws = draws;
+        stats.lastShadowPassTriangles = triangles;
+        stats.drawCallsSubmitted += draws;
+        stats.trianglesSubmitted += triangles;
     }
     float rotationAngle = 0.0f; 
+    float previousRotationAngle = 0.0f;
 
-    void initMuseum() {
-        auto museum = std::make_shared<Model>("../Models/muzeu.obj", "../Models/");
-        museum->setPosition(glm::vec3(0.0f, 0.0f, 0.0f));
-        museum->setRotation(glm::vec3(0.0f, 45.0f, 0.0f));
-        museum->setScale(glm::vec3(1.0f));
-        models.push_back(museum);
+    void applyAnimation(float angle) {
+        for (size_t index : animatedModels) {
+            models[index]->setRotation(glm::vec3(0.0f, angle, 0.0f));
+        }
     }
 
-    void initTepes() {
-        auto VladTepes = std::make_shared<Model>("../Models/VladTepes/vlad_tepes.obj", "../Models/VladTepes/");
-        VladTepes->setPosition(glm::vec3(6.69f, 3.65f, 4.95f));
-        VladTepes->setRotation(glm::vec3(0.0f, 176.0f, 0.0f));
-        VladTepes->setScale(glm::vec3(0.0007f));
-        VladTepes->setName("VladTepes");
-        models.push_back(VladTepes);
+    void buildSpatialIndex() {
+        bvh.clear();
+        modelProxies.clear();
+        for (size_t i = 0; i < models.size(); i++) {
+            modelProxies.push_back(bvh.createProxy(models[i]->getWorldBounds(modelMatrices[i]), static_cast<int>(i)));
+        }
     }
 
-    void initCavaler()
-    {
-        auto Cavaler = std::make_shared<Model>("../Models/Cavaler/3D_scan_armor_henry_II_of_france.obj", "../Models/Cavaler/");
-        
-        Cavaler->setPosition(glm::vec3(-0.2f, 2.0f, -2.2f));
-        Cavaler->setRotation(glm::vec3(90.0f, 175.0f, -65.0f));
-        Cavaler->setScale(glm::vec3(0.03f));
-        Cavaler->setName("Cavaler");
-        models.push_back(Cavaler);
+    // Marks the models whose bounds touch the frustum; returns how many were culled.
+    size_t cullModels(const glm::mat4& viewProjection) {
+        visibleModels.assign(models.size(), 0);
+        bvh.queryFrustum(Frustum(viewProjection), [this](int index) {
+            visibleModels[index] = 1;
+        });
+        return static_cast<size_t>(std::count(visibleModels.begin(), visibleModels.end(), 0));
     }
 
-    void initTelescope()
-    {
-        auto Telescope = std::make_shared<Model>("../Models/Telescope/telescope.obj", "../Models/Telescope/");
+    // Indices of the models marked in visibleModels, valid until the frame is recorded.
+    FrameArray<uint32_t> collectVisibleModels() {
+        FrameArray<uint32_t> visible(frameArena, models.size());
+        for (size_t m = 0; m < models.size(); m++) {
+            if (visibleModels[m]) visible.push_back(static_cast<uint32_t>(m));
+        }
+        return visible;
+    }
 
-        Telescope->setPosition(glm::vec3(-4.1f, 2.10f, -4.8f));
-        Telescope->setRotation(glm::vec3(0.0f, 45.0f, 0.0f));
-        Telescope->setScale(glm::vec3(0.008f));
-        Telescope->setName("Telescope");
-        models.push_back(Telescope);
+    // Rasterizes the occluders from the camera and hides the visible models that are
+    // completely behind them; returns how many were culled.
+    size_t cullOccludedModels(const glm::mat4& viewProjection) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        occlusionBuffer.clear(viewProjection);
+        occlusionBuffer.rasterize(occluderTriangles);
+        occlusionBuffer.buildHierarchy();
+
+        size_t culled = 0;
+        for (size_t m = 0; m < models.size(); m++) {
+            if (!visibleModels[m] || models[m]->isOccluder()) continue;
+            if (!occlusionBuffer.isVisible(models[m]->getWorldBounds(modelMatrices[m]))) {
+                visibleModels[m] = 0;
+                culled++;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        stats.occlusionPasses++;
+        stats.occlusionSeconds += seconds;
+        stats.lastOcclusionMilliseconds = seconds * 1000.0;
+        stats.lastOccludedObjects = culled;
+        stats.objectsOcclusionCulled += culled;
+        return culled;
     }
 
-public:
-    Scene() : camera(std::make_unique<Camera>()),
-        shader(std::make_unique<Shader>("../Shaders/vertex_shader.glsl",
-            "../Shaders/fragment_shader.glsl")),
-        lightIndicatorShader(std::make_unique<Shader>("../Shaders/light_indicator_vertex.glsl",
-            "../Shaders/light_indicator_fragment.glsl")),
-        light1(glm::vec3(5.0f, 4.0f, 5.0f),     
-            glm::vec3(0.2f, 0.15f, 0.1f),       
-            glm::vec3(0.8f, 0.6f, 0.4f),        
-            glm::vec3(1.0f, 0.8f, 0.6f)),
-        light2(glm::vec3(-4.6f, 4.0f, -4.5f),      
-            glm::vec3(0.1f, 0.15f, 0.2f),       
-            glm::vec3(0.4f, 0.6f, 0.8f),       
-            glm::vec3(0.6f, 0.8f, 1.0f)),
-        light3(glm::vec3(0.0f, 4.0f, 0.0f),        
-            glm::vec3(0.15f),                    
-            glm::vec3(0.7f),                     
-            glm::vec3(0.9f)) {
+    bool collidesWithExhibit(const glm::vec3& position) const {
+        AABB body(position - glm::vec3(CAMERA_RADIUS, 1.0f, CAMERA_RADIUS),
+            position + glm::vec3(CAMERA_RADIUS, 0.1f, CAMERA_RADIUS));
+        bool hit = false;
+        bvh.query(body, [&](int index) {
+            if (!hit && models[index]->isExhibit()) {
+                hit = models[index]->getWorldBounds(modelMatrices[index]).overlaps(body);
+            }
+        });
+        return hit;
+    }
 
-        projection = glm::perspective(glm::radians(45.0f), (float)mode->width / (float)mode->height, 0.1f, 100.0f);
-        initMuseum();
-        initTepes();
-        initCavaler();
-        initTelescope();
-        setupLights();
-
-        shadowMapShader = std::make_unique<Shader>(
-            "../Shaders/shadow_map_vertex.glsl",
-            "../Shaders/shadow_map_fragment.glsl"
-        );
-        initShadowMaps();
+    void computeModelMatrices() {
+        modelMatrices.resize(models.size());
+        jobs.parallelFor(models.size(), 16, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                modelMatrices[i] = models[i]->getModelMatrix();
+            }
+        });
+    }
 
-        //ROOM 1 
-
-       addModel("../Models/Chest/chest.obj", "../Models/Chest/",
-            glm::vec3(-6.4f, 2.20f, -4.6f),
-            glm::vec3(0.0f, -47.0f, 0.0f),
-            glm::vec3(0.25f));
-
-        addModel("../Models/TV/TV.obj", "../Models/TV/",
-            glm::vec3(-2.7f, 3.50f, -4.5f),
-            glm::vec3(0.0f, -220.0f, 0.0f),
-            glm::vec3(0.001f));
-
-        addModel("../Models/Old_Table/old_table.obj", "../Models/Old_Table/",
-            glm::vec3(-2.55f, 2.20f, -4.35f),
-            glm::vec3(0.0f, -45.0f, 0.0f),
-            glm::vec3(1.1f));
-
-        addModel("../Models/Camera/camera.obj", "../Models/Camera/",
-            glm::vec3(-1.6f, 2.74f, -3.6f),
-            glm::vec3(0.0f, 0.0f, 0.0f),
-            glm::vec3(0.3f));
-
-        addModel("../Models/Cash_Register/cash_register.obj", "../Models/Cash_Register/",
-            glm::vec3(-1.2f, 3.0f, -3.1f),
-            glm::vec3(0.0f, 0.0f, 0.0f),
-            glm::vec3(0.001f));
-
-        addModel("../Models/Table/table.obj", "../Models/Table/",
-            glm::vec3(-1.3f, 2.10f, -3.4f),
-            glm::vec3(0.0f, 130.0f, 0.0f),
-            glm::vec3(0.1f));
-
-       addModel("../Models/Medieval_Desk/medieval_desk.obj", "../Models/Medieval_Desk/",
-            glm::vec3(-3.6f, 2.50f, -1.5f),
-            glm::vec3(0.0f, 131.0f, 0.0f),
-            glm::vec3(0.6f));
-
-        addModel("../Models/Old_Torah_Scroll/old_torah_scroll.obj", "../Models/Old_Torah_Scroll/",
-            glm::vec3(-3.65f, 2.9f, -1.45f),
-            glm::vec3(0.0f, 131.0f, 0.0f),
-            glm::vec3(0.06f));
-
-        addModel("../Models/Telephone/telephone.obj", "../Models/Telephone/",
-            glm::vec3(-4.6f, 3.32f, -2.6f),
-            glm::vec3(0.0f, 135.0f, 0.0f),
-            glm::vec3(0.24f));
-
-        addModel("../Models/Book_Shelf/bookshelf.obj", "../Models/Book_Shelf/",
-            glm::vec3(-4.8f, 3.0f, -2.7f),
-            glm::vec3(0.0f, 135.0f, 0.0f),
-            glm::vec3(1.6f));
-
-        addModel("../Models/Lantern/lantern.obj", "../Models/Lantern/",
-            glm::vec3(-4.9f, 3.08f, -2.9f),
-            glm::vec3(0.0f, 135.0f, 0.0f),
-            glm::vec3(0.2f));
-       
-        //ROOM 2
-
-        addModel("../Models/Calaret/calaret.obj", "../Models/Calaret/",
-            glm::vec3(-2.5f, 2.45f, -0.9f),
-            glm::vec3(0.0f, 50.0f, 0.0f),
-            glm::vec3(0.5f));
-
-        addModel("../Models/Old_Wooden_Cart/old_wooden_cart.obj", "../Models/Old_Wooden_Cart/",
-            glm::vec3(1.2f, 2.20f, -0.6f),
-            glm::vec3(0.0f, 45.0f, 0.0f),
-           glm::vec3(0.007f));
-
-        addModel("../Models/Sword/sword.obj", "../Models/Sword/",
-            glm::vec3(-1.7f, 2.20f, 0.5f),
-           glm::vec3(0.0f, 131.0f, 0.0f),
-            glm::vec3(1.0f));
-
-        addModel("../Models/Canon/OldShipCannon.obj", "../Models/Canon/",
-            glm::vec3(0.02f, 2.2f, 2.1f),
-            glm::vec3(0.0f, 90.0f, 0.0f),
-           glm::vec3(0.4f));
-        
-        // ROOM 3
-
-        addModel("../Models/Stand/stand.obj", "../Models/Stand/",
-            glm::vec3(10.15f, 2.20f,5.2f),
-            glm::vec3(0.0f, 176.0f, 0.0f),
-            glm::vec3(0.007f));
-
-        addModel("../Models/Bran/model.obj", "../Models/Bran/",
-            glm::vec3(4.f, 1.1f, 6.0f),
-             glm::vec3(0.0f, 130.0f, 0.0f),
-             glm::vec3(0.15f));
-
-        addModel("../Models/Stema/model.obj", "../Models/Stema/",
-            glm::vec3(6.22f, 2.8f, 6.27f),
-            glm::vec3(0.0f, 230.0f, 0.0f),
-            glm::vec3(0.02f));
-
-        addModel("../Models/Medieval_Chest/medieval_chest.obj", "../Models/Medieval_Chest/",
-            glm::vec3(2.034f, 2.40f, 4.34f),
-            glm::vec3(0.0f, -45.0f, 0.0f),
-            glm::vec3(0.0006f));
-
-          addModel("../Models/Table/Table.obj", "../Models/Table/",
-              glm::vec3(4.6f, 2.1f, 2.6f),
-              glm::vec3(0.0f, 130.0f, 0.0f),
-              glm::vec3(0.1f));
-
-          addModel("../Models/Gun/GunMesh.obj", "../Models/Gun/",
-              glm::vec3(3.841f, 2.85f, 2.5f),
-              glm::vec3(0.0f, 130.0f, 0.0f),
-              glm::vec3(0.001f));
+    // World matrices are shared by the shadow and main passes. Only animated models
+    // move between residency changes, so only theirs are rebuilt each frame.
+    void updateModelMatrices() {
+        // Refit only what moves; fat leaves absorb small rotations without touching the tree.
+        for (size_t index : animatedModels) {
+            modelMatrices[index] = models[index]->getModelMatrix();
+            bvh.moveProxy(modelProxies[index], models[index]->getWorldBounds(modelMatrices[index]));
+        }
     }
 
-    void addModel(const char* objPath, const char* mtlBaseDir,
-        const glm::vec3& position = glm::vec3(0.0f),
-        const glm::vec3& rotation = glm::vec3(0.0f),
-        const glm::vec3& scale = glm::vec3(1.0f)) {
+    // Missing or stale bakes are not fatal; the scene falls back to real-time lighting.
+    static std::unique_ptr<BakedLighting> loadBakedLighting(const SceneDescription& description, const std::string& scenePath) {
+        if (description.bakedLightingPath.empty()) return nullptr;
+        if (!std::ifstream(description.bakedLightingPath).good()) {
+            std::cout << "No baked lighting at " << description.bakedLightingPath << ", run LightmapBaker to create it\n";
+            return nullptr;
+        }
+
         try {
-            auto model = std::make_shared<Model>(objPath, mtlBaseDir);
-            model->setPosition(position);
-            model->setRotation(rotation);
-            model->setScale(scale);
-            models.push_back(model);
-            std::cout << "Loaded model: " << objPath << "\n";
+            auto baked = std::make_unique<BakedLighting>(BakedLighting::load(description.bakedLightingPath));
+            if (baked->sceneHash != BakedLighting::hashFile(scenePath)) {
+                std::cout << description.bakedLightingPath << " was baked from a different version of "
+                    << scenePath << ", run LightmapBaker again\n";
+                return nullptr;
+            }
+            return baked;
         }
         catch (const std::exception& e) {
-            std::cerr << "Error loading model: " << objPath << "\nException: " << e.what() << "\n";
+            std::cerr << "Ignoring baked lighting: " << e.what() << std::endl;
+            return nullptr;
         }
     }
 
+    void initLightmap() {
+        if (!bakedLighting) return;
+
+        glGenTextures(1, &lightmapTexture);
+        glBindTexture(GL_TEXTURE_2D, lightmapTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bakedLighting->atlasWidth, bakedLighting->atlasHeight, 0,
+            GL_RGB, GL_FLOAT, bakedLighting->atlas.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // The atlas is on the GPU now; only the coordinates and probes are still needed.
+        std::vector<float>().swap(bakedLighting->atlas);
+
+        // RGB16F is usually stored with four channels.
+        ResourceRegistry& registry = ResourceRegistry::global();
+        lightmapResourceId = registry.track(ResourceCategory::Lightmap, "Scene",
+            static_cast<size_t>(bakedLighting->atlasWidth) * bakedLighting->atlasHeight * 8);
+        bakedResourceId = registry.track(ResourceCategory::BakedData, "Scene", bakedLighting->getMemorySize());
+    }
 
-    void render() {
-        renderShadowMaps();
+    bool isBakedLightingActive() const {
+        return bakedLighting && bakedLightingEnabled && lightEnabled;
+    }
 
-        glViewport(0, 0, mode->width, mode->height);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    void setLightUniforms(RenderCommandList& list, const SceneUniforms& uniforms) {
+        for (size_t i = 0; i < lights.size(); i++) {
+            list.bindTexture(1 + i, shadowMaps[i].depthMap);
+            list.setInt(uniforms.shadowMaps[i], 1 + i);
+            list.setMat4(uniforms.lightSpaceMatrices[i], shadowMaps[i].lightSpaceMatrix);
+        }
 
-        shader->use();
-        shader->setMat4("projection", projection);
-        shader->setMat4("view", camera->getViewMatrix());
-        shader->setVec3("viewPos", camera->getPosition());
+        for (size_t i = 0; i < lights.size(); i++) {
+            const Light& light = lights[i];
+            const SceneUniforms::LightUniforms& locations = uniforms.lights[i];
+
+            list.setVec3(locations.position, light.position);
+            list.setVec3(locations.ambient, light.ambient);
+            list.setVec3(locations.diffuse, light.diffuse);
+            list.setVec3(locations.specular, light.specular);
+            list.setFloat(locations.constant, light.constant);
+            list.setFloat(locations.linear, light.linear);
+            list.setFloat(locations.quadratic, light.quadratic);
+        }
+    }
+
+    void resolveUniforms() {
+        litUniforms = SceneUniforms::resolve(litShader);
+        unlitUniforms = SceneUniforms::resolve(unlitShader);
+        bakedUniforms = SceneUniforms::resolve(bakedShader);
+        probeLitUniforms = SceneUniforms::resolve(probeLitShader);
+        shadowMapUniforms = SceneUniforms::resolve(shadowMapShader);
+    }
 
-        for (int i = 0; i < 3; i++) {
-            glActiveTexture(GL_TEXTURE1 + i);
-            glBindTexture(GL_TEXTURE_2D, shadowMaps[i].depthMap);
-            shader->setInt("shadowMap" + std::to_string(i + 1), 1 + i);
-            shader->setMat4("lightSpaceMatrix" + std::to_string(i + 1), shadowMaps[i].lightSpaceMatrix);
+    void requestShaders() {
+        litShader = shaderLibrary.request("../Shaders/vertex_shader.glsl", "../Shaders/fragment_shader.glsl",
+            { "LIGHT_COUNT " + std::to_string(lights.size()), "SHADOWS 1", "PCF_RADIUS " + std::to_string(PCF_RADIUS) });
+        unlitShader = shaderLibrary.request("../Shaders/vertex_shader.glsl", "../Shaders/fragment_shader.glsl",
+            { "LIGHT_COUNT 0", "SHADOWS 0" });
+        shadowMapShader = shaderLibrary.request("../Shaders/shadow_map_vertex.glsl",
+            "../Shaders/shadow_map_fragment.glsl");
+        lightIndicatorShader = shaderLibrary.request("../Shaders/light_indicator_vertex.glsl",
+            "../Shaders/light_indicator_fragment.glsl");
+        if (bakedLighting) {
+            bakedShader = shaderLibrary.request("../Shaders/vertex_shader.glsl", "../Shaders/fragment_shader.glsl",
+                { "LIGHT_COUNT 0", "SHADOWS 0", "BAKED_LIGHTING 1" });
+            probeLitShader = shaderLibrary.request("../Shaders/vertex_shader.glsl", "../Shaders/fragment_shader.glsl",
+                { "LIGHT_COUNT " + std::to_string(lights.size()), "SHADOWS 1", "PCF_RADIUS " + std::to_string(PCF_RADIUS),
+                  "PROBE_LIGHTING 1" });
         }
+    }
 
-        if (lightEnabled) {
-            for (int i = 1; i <= 3; i++) {
-                const Light& light = (i == 1) ? light1 : (i == 2) ? light2 : light3;
-                std::string prefix = "light" + std::to_string(i);
-
-                shader->setVec3(prefix + ".position", light.position);
-                shader->setVec3(prefix + ".ambient", light.ambient);
-                shader->setVec3(prefix + ".diffuse", light.diffuse);
-                shader->setVec3(prefix + ".specular", light.specular);
-                shader->setFloat(prefix + ".constant", light.constant);
-                shader->setFloat(prefix + ".linear", light.linear);
-                shader->setFloat(prefix + ".quadratic", light.quadratic);
+    static MipStreamingSettings textureStreamingSettings(const SceneDescription& description) {
+        MipStreamingSettings settings;
+        settings.budget = description.textureBudget;
+        return settings;
+    }
+
+    // Reports how large each visible model appears: the bounding sphere projected at the
+    // current render height. Coarse, but enough to pick a mip level per texture.
+    void requestTextureLevels() {
+        float pixelsPerUnit = projection[1][1] * 0.5f * dynamicResolution->getRenderHeight();
+        glm::vec3 eye = camera->getPosition();
+        for (size_t m = 0; m < models.size(); m++) {
+            if (!visibleModels[m]) continue;
+            AABB bounds = models[m]->getWorldBounds(modelMatrices[m]);
+            float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+            float distance = std::max(glm::length(bounds.getCenter() - eye), radius);
+            float projectedPixels = 2.0f * radius * pixelsPerUnit / distance;
+            for (const auto& texture : models[m]->getTextures()) {
+                textureStreamer.addFeedback(texture.get(), projectedPixels);
+            }
+        }
+        textureStreamer.update();
+    }
+
+    // Takes the resident set from the streaming manager. Scene must not keep references
+    // to evicted models: their GL objects are deleted by a task in the next frame.
+    void rebuildResidentModels() {
+        models.clear();
+        animatedModels.clear();
+        occluderTriangles.clear();
+        streaming.forEachResident([this](const ModelDescription& desc, const std::shared_ptr<Model>& model,
+            const std::vector<glm::vec3>& occluder) {
+            if (desc.hasTag("rotate")) {
+                animatedModels.push_back(models.size());
+            }
+            models.push_back(model);
+            occluderTriangles.insert(occluderTriangles.end(), occluder.begin(), occluder.end());
+        });
+
+        applyAnimation(rotationAngle);
+        computeModelMatrices();
+        buildSpatialIndex();
+        visibleModels.assign(models.size(), 1);
+        textureStreamer.setTextures(models);
+
+        // Exhibits only rotate in place, so one probe lookup per residency change is enough.
+        modelProbes.assign(models.size(), BakedLighting::AmbientCube());
+        if (bakedLighting) {
+            for (size_t i = 0; i < models.size(); i++) {
+                modelProbes[i] = bakedLighting->sampleProbes(models[i]->getWorldBounds(modelMatrices[i]).getCenter());
             }
         }
+    }
+
+public:
+    Scene(JobSystem& jobs, const std::string& scenePath = "../Scenes/muzeu.scene") : jobs(jobs),
+        description(SceneDescription::load(scenePath)),
+        bakedLighting(loadBakedLighting(description, scenePath)),
+        camera(std::make_unique<Camera>()),
+        streaming(jobs, description, stats, bakedLighting.get()),
+        textureStreamer(jobs, stats, textureStreamingSettings(description)) {
+
+        ResourceRegistry::global().setBudgets(description.gpuBudget, description.cpuBudget);
+        lights = description.lights;
+        if (lights.size() > MAX_LIGHTS) {
+            std::cerr << "Scene has " << lights.size() << " lights, only the first " << MAX_LIGHTS << " are used\n";
+            lights.resize(MAX_LIGHTS);
+        }
+
+        projection = glm::perspective(glm::radians(45.0f), (float)mode->width / (float)mode->height, 0.1f, 100.0f);
+
+        // Compiles run in the driver while the models load; they are collected after.
+        requestShaders();
+        initShadowMaps();
+        initLightmap();
+        dynamicResolution = std::make_unique<DynamicResolution>(mode->width, mode->height);
+
+        // Only the starting room and its neighbours are loaded up front; the rest is
+        // streamed in as the visitor walks through the museum.
+        streaming.loadNow(camera->getPosition());
+        shaderLibrary.finalizeAll();
+        resolveUniforms();
+        rebuildResidentModels();
+        camera->setCollisionTest([this](const glm::vec3& position) {
+            return collidesWithExhibit(position);
+        });
+    }
+
+    // Records the frame into list; no GL calls are made here, so this can run while
+    // the render thread is still submitting the previous frame.
+    void record(RenderCommandList& list, float alpha = 1.0f) {
+        bool resolutionChanged = dynamicResolution->update();
+        if (resolutionChanged) {
+            stats.resolutionChanges++;
+        }
+        bool streamingWork = streaming.isBusy() || textureStreamer.isBusy();
+        streaming.recordGpuWork(list);
+        textureStreamer.recordGpuWork(list);
+
+        float targetAngle = rotationAngle;
+        if (targetAngle < previousRotationAngle) {
+            targetAngle += 360.0f;
+        }
+        applyAnimation(glm::mix(previousRotationAngle, targetAngle, alpha));
+        updateModelMatrices();
+
+        // Shadow maps only depend on light placement and geometry; camera and
+        // settings changes reuse the maps from the previous frame. The unlit variant
+        // does not sample them at all.
+        if (lightEnabled && (dirtyFlags & (DIRTY_LIGHTS | DIRTY_MODELS))) {
+            recordShadowMaps(list);
+        }
         else {
-            Light darkLight(
-                glm::vec3(0.0f),
-                glm::vec3(0.05f),
-                glm::vec3(0.0f),
-                glm::vec3(0.0f)
-            );
-
-            for (int i = 1; i <= 3; i++) {
-                std::string prefix = "light" + std::to_string(i);
-                shader->setVec3(prefix + ".position", darkLight.position);
-                shader->setVec3(prefix + ".ambient", darkLight.ambient);
-                shader->setVec3(prefix + ".diffuse", darkLight.diffuse);
-                shader->setVec3(prefix + ".specular", darkLight.specular);
-                shader->setFloat(prefix + ".constant", 1.0f);
-                shader->setFloat(prefix + ".linear", 0.0f);
-                shader->setFloat(prefix + ".quadratic", 0.0f);
+            stats.skipShadowPass();
+        }
+
+        // Uploads and shadow maps cost the same at any scale, so only the main pass is
+        // timed for the resolution controller.
+        dynamicResolution->beginFrame(list);
+        dynamicResolution->bindTarget(list);
+        list.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        bool baked = isBakedLightingActive();
+        Shader* shader = baked ? probeLitShader : lightEnabled ? litShader : unlitShader;
+        const SceneUniforms& uniforms = baked ? probeLitUniforms : lightEnabled ? litUniforms : unlitUniforms;
+        list.useProgram(shader->getProgram());
+        list.setMat4(uniforms.projection, projection);
+        glm::mat4 view = camera->getViewMatrix(alpha);
+        list.setMat4(uniforms.view, view);
+        list.setVec3(uniforms.viewPos, camera->getPosition(alpha));
+
+        if (lightEnabled) {
+            setLightUniforms(list, uniforms);
+        }
+
+        uint64_t draws = 0;
+        uint64_t triangles = 0;
+        stats.objectsFrustumCulled += cullModels(projection * view);
+        if (occlusionCulling) {
+            cullOccludedModels(projection * view);
+        }
+        requestTextureLevels();
+
+        // Split the visible set once into this frame's draw lists.
+        FrameArray<uint32_t> shadedModels(frameArena, models.size());
+        FrameArray<uint32_t> lightmappedModels(frameArena, baked ? models.size() : 0);
+        for (size_t m = 0; m < models.size(); m++) {
+            if (!visibleModels[m]) continue;
+            if (baked && models[m]->isLightmapped()) lightmappedModels.push_back(static_cast<uint32_t>(m));
+            else shadedModels.push_back(static_cast<uint32_t>(m));
+        }
+
+        for (uint32_t m : shadedModels) {
+            const auto& model = models[m];
+            if (baked) {
+                for (int face = 0; face < 6; face++) {
+                    list.setVec3(uniforms.ambientCube[face], modelProbes[m].faces[face]);
+                }
+            }
+            list.setMat4(uniforms.model, modelMatrices[m]);
+            model->record(list);
+            draws += model->getMeshCount();
+            triangles += model->getTriangleCount();
+        }
+
+        // Lightmapped geometry needs neither lights nor shadow maps.
+        if (baked) {
+            list.useProgram(bakedShader->getProgram());
+            list.setMat4(bakedUniforms.projection, projection);
+            list.setMat4(bakedUniforms.view, view);
+            list.bindTexture(LIGHTMAP_UNIT, lightmapTexture);
+            list.setInt(bakedUniforms.lightmap, LIGHTMAP_UNIT);
+            for (uint32_t m : lightmappedModels) {
+                const auto& model = models[m];
+                list.setMat4(bakedUniforms.model, modelMatrices[m]);
+                model->record(list);
+                draws += model->getMeshCount();
+                triangles += model->getTriangleCount();
             }
         }
 
-        for (const auto& model : models) {
-            shader->setMat4("model", model->getModelMatrix());
-            model->draw(*shader);
+        stats.framesRendered++;
+        stats.lastMainPassDraws = draws;
+        stats.lastMainPassTriangles = triangles;
+        stats.drawCallsSubmitted += draws;
+        stats.trianglesSubmitted += triangles;
+        stats.lastResolutionScale = dynamicResolution->getScale();
+        stats.lastGpuMilliseconds = dynamicResolution->getLastGpuMilliseconds();
+        dynamicResolution->endFrame(list);
+        list.setPresent(true);
+
+        frameArena.reset();
+        stats.frameArenaPeakBytes = frameArena.getPeakBytes();
+        streamingWork = streamingWork || streaming.isBusy() || textureStreamer.isBusy();
+        quietFrames = streamingWork ? 0 : quietFrames + 1;
+
+        // While something is still interpolating between two updates the next frame differs too.
+        dirtyFlags = DIRTY_NONE;
+        if (camera->isMoving()) {
+            dirtyFlags |= DIRTY_CAMERA;
+        }
+        if (rotationAngle != previousRotationAngle) {
+            dirtyFlags |= DIRTY_MODELS;
+        }
+        // Keep measuring until the scale settles, so a still view ends up at the
+        // resolution the GPU can afford instead of wherever motion left it.
+        if (resolutionChanged || dynamicResolution->isSettling()) {
+            dirtyFlags |= DIRTY_SETTINGS;
+        }
+    }
+
+    bool needsRedraw() const {
+        return dirtyFlags != DIRTY_NONE || streaming.hasPendingGpuWork() || textureStreamer.hasPendingGpuWork();
+    }
+    void markDirty(unsigned int flags) { dirtyFlags |= flags; }
+    void skipFrame() { stats.skipFrame(); }
+
+    // Past the warm-up and with no streaming work in the last few frames; frames from
+    // here on are expected not to allocate.
+    bool isSteadyState() const {
+        return stats.framesRendered >= ALLOCATION_WARMUP_FRAMES && quietFrames >= ALLOCATION_QUIET_FRAMES;
+    }
+
+    // allocations: heap allocations made while updating and recording the last
+    // presented frame (and by the render thread while submitting earlier ones).
+    void reportFrameAllocations(uint64_t allocations) {
+        stats.lastFrameAllocations = allocations;
+        if (!isSteadyState()) return;
+
+        stats.steadyFramesChecked++;
+        if (allocations == 0) return;
+        stats.steadyFramesAllocating++;
+        if (!allocationWarningShown) {
+            std::cerr << "Warning: a steady-state frame made " << allocations
+                << " heap allocations; later ones are only counted in the stats\n";
+            allocationWarningShown = true;
         }
     }
 
+    void setAnimationsPaused(bool paused) { animationsPaused = paused; }
+
+    void setOcclusionCulling(bool enabled) {
+        if (occlusionCulling != enabled) {
+            occlusionCulling = enabled;
+            dirtyFlags |= DIRTY_SETTINGS;
+        }
+    }
+    bool isOcclusionCulling() const { return occlusionCulling; }
+
+    void setBakedLighting(bool enabled) {
+        if (bakedLightingEnabled != enabled) {
+            bakedLightingEnabled = enabled;
+            dirtyFlags |= DIRTY_SETTINGS;
+        }
+    }
+    bool isBakedLighting() const { return bakedLightingEnabled; }
+    bool hasBakedLighting() const { return bakedLighting != nullptr; }
+
+    void setDynamicResolution(bool enabled) {
+        if (dynamicResolution->isEnabled() != enabled) {
+            dynamicResolution->setEnabled(enabled);
+            dirtyFlags |= DIRTY_SETTINGS;
+        }
+    }
+    bool isDynamicResolution() const { return dynamicResolution->isEnabled(); }
+
+    const RenderStats& getStats() const { return stats; }
+
+    // Casts a ray through the centre of the screen (the cursor is captured) and returns
+    // the closest exhibit it hits, or nullptr.
+    Model* pickExhibit(float maxDistance = 20.0f) const {
+        Ray ray{ camera->getPosition(), camera->getFront() };
+        Model* closest = nullptr;
+        float closestDistance = maxDistance;
+        bvh.raycast(ray, maxDistance, [&](int index, float) {
+            float distance;
+            const Model* model = models[index].get();
+            if (model->isExhibit() &&
+                ray.intersects(model->getWorldBounds(modelMatrices[index]), closestDistance, distance) &&
+                distance < closestDistance) {
+                closestDistance = distance;
+                closest = models[index].get();
+            }
+            return closestDistance;
+        });
+        return closest;
+    }
+
 
 
     void update(GLFWwindow* window, float deltaTime) {
         camera->processKeyboard(window, deltaTime);
+        if (camera->isMoving()) {
+            dirtyFlags |= DIRTY_CAMERA;
+        }
 
-        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (streaming.update(camera->getPosition())) {
+            rebuildResidentModels();
+            dirtyFlags |= DIRTY_MODELS;
+            quietFrames = 0;
+        }
+
+        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !lightEnabled) {
             lightEnabled = true;
+            // Shadow maps were not kept up to date while the lights were off.
+            dirtyFlags |= DIRTY_SETTINGS | DIRTY_LIGHTS;
         }
-        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS) {
+        if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && lightEnabled) {
             lightEnabled = false;
+            dirtyFlags |= DIRTY_SETTINGS;
         }
 
-        rotationAngle += 20.0f * deltaTime;
-        if (rotationAngle >= 360.0f) {
-            rotationAngle -= 360.0f; 
-        }
-
-        for (auto& model : models) {
-            if (model->getName() == "VladTepes" || model->getName()=="Telescope") { 
-                model->setRotation(glm::vec3(0.0f, rotationAngle, 0.0f));
+        previousRotationAngle = rotationAngle;
+        if (!animationsPaused) {
+            rotationAngle += 20.0f * deltaTime;
+            if (rotationAngle >= 360.0f) {
+                rotationAngle -= 360.0f; 
             }
+            dirtyFlags |= DIRTY_MODELS;
         }
     }
 
     Camera* getCamera() { return camera.get(); }
 
     ~Scene() {
-        glDeleteVertexArrays(1, &lightVAO);
-        glDeleteBuffers(1, &lightVBO);
-        glDeleteFramebuffers(1, &depthMapFBO);
-        glDeleteTextures(1, &depthMap);
+        ResourceRegistry& registry = ResourceRegistry::global();
+        for (auto& shadowMap : shadowMaps) {
+            glDeleteFramebuffers(1, &shadowMap.depthMapFBO);
+            glDeleteTextures(1, &shadowMap.depthMap);
+            registry.release(shadowMap.resourceIds[0]);
+            registry.release(shadowMap.resourceIds[1]);
+        }
+        glDeleteTextures(1, &lightmapTexture);
+        registry.release(lightmapResourceId);
+        registry.release(bakedResourceId);
     }
 };
\ No newline at end of file
@@ -0,0 +1 @@
+#include "SceneDescription.h"
\ No newline at end of file
@@ -0,0 +1,231 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Light.h"
+
+// A room is an oriented box (rotated around Y) used to find where the visitor is.
+struct RoomDescription {
+    std::string name;
+    glm::vec3 center{ 0.0f };
+    glm::vec3 size{ 1.0f };
+    float yaw = 0.0f;
+    std::vector<int> neighbours;
+
+    bool contains(const glm::vec3& point) const {
+        glm::vec3 offset = point - center;
+        float angle = glm::radians(yaw);
+        float localX = offset.x * std::cos(angle) - offset.z * std::sin(angle);
+        float localZ = offset.x * std::sin(angle) + offset.z * std::cos(angle);
+        return std::fabs(localX) <= size.x * 0.5f &&
+            std::fabs(offset.y) <= size.y * 0.5f &&
+            std::fabs(localZ) <= size.z * 0.5f;
+    }
+};
+
+struct ModelDescription {
+    std::string objPath;
+    std::string mtlBaseDir;
+    glm::vec3 position{ 0.0f };
+    glm::vec3 rotation{ 0.0f };
+    glm::vec3 scale{ 1.0f };
+    std::string name;
+    int room = -1;                  // -1 = always resident
+    std::vector<std::string> tags;
+    bool required = false;
+    bool exhibit = true;
+    bool occluder = false;
+
+    bool hasTag(const std::string& tag) const {
+        return std::find(tags.begin(), tags.end(), tag) != tags.end();
+    }
+};
+
+// Contents of a .scene file. The format is line based, '#' starts a comment:
+//
+//   budget <megabytes>      model memory the streaming manager keeps resident
+//   gpu_budget <megabytes>  all GL resources, warned about when exceeded (optional)
+//   cpu_budget <megabytes>  CPU asset memory, warned about when exceeded (optional)
+//   texture_budget <megabytes>  streamed texture mip levels (optional)
+//   baked <path>            lighting written by LightmapBaker, optional
+//   room <name> center <x y z> size <x y z> [yaw <degrees>]
+//   connect <room> <room>
+//   model <obj> <mtl dir> [room <name>] [name <name>] [position <x y z>]
+//         [rotation <x y z>] [scale <s> | scale <x y z>] [tag <tag>]...
+//         [required] [static] [occluder]
+//   light position <x y z> ambient <r g b> diffuse <r g b> specular <r g b>
+//         [attenuation <constant linear quadratic>]
+//
+// Models without a room are always resident; "static" models are not exhibits. A
+// "required" model that fails to load is an error, whether it is loaded at startup
+// or streamed in later, and stops the application; other models are skipped with a
+// warning.
+struct SceneDescription {
+    std::vector<RoomDescription> rooms;
+    std::vector<ModelDescription> models;
+    std::vector<Light> lights;
+    size_t memoryBudget = 512u * 1024u * 1024u;
+    size_t gpuBudget = 0;           // 0 = unlimited
+    size_t cpuBudget = 0;
+    size_t textureBudget = 512u * 1024u * 1024u;
+    std::string bakedLightingPath;
+
+    int findRoom(const std::string& name) const {
+        for (size_t i = 0; i < rooms.size(); i++) {
+            if (rooms[i].name == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Returns the room containing point, preferring the one whose centre is closest.
+    int roomAt(const glm::vec3& point) const {
+        int best = -1;
+        float bestDistance = 0.0f;
+        for (size_t i = 0; i < rooms.size(); i++) {
+            if (!rooms[i].contains(point)) continue;
+            float distance = glm::length(point - rooms[i].center);
+            if (best < 0 || distance < bestDistance) {
+                best = static_cast<int>(i);
+                bestDistance = distance;
+            }
+        }
+        return best;
+    }
+
+    static SceneDescription load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open scene file: " + path);
+        }
+
+        SceneDescription scene;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+
+            std::istringstream tokens(line);
+            std::string keyword;
+            if (!(tokens >> keyword)) continue;
+
+            auto fail = [&](const std::string& message) {
+                throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + message);
+            };
+            auto readVec3 = [&](glm::vec3& value) {
+                if (!(tokens >> value.x >> value.y >> value.z)) fail("expected three numbers");
+            };
+            auto readWord = [&](std::string& value) {
+                if (!(tokens >> value)) fail("expected a value after " + keyword);
+            };
+            auto roomIndex = [&](const std::string& name) {
+                int index = scene.findRoom(name);
+                if (index < 0) fail("unknown room " + name);
+                return index;
+            };
+
+            if (keyword == "budget" || keyword == "gpu_budget" || keyword == "cpu_budget" || keyword == "texture_budget") {
+                double megabytes = 0.0;
+                if (!(tokens >> megabytes) || megabytes <= 0.0) fail("expected a budget in megabytes");
+                size_t bytes = static_cast<size_t>(megabytes * 1024.0 * 1024.0);
+                if (keyword == "budget") scene.memoryBudget = bytes;
+                else if (keyword == "gpu_budget") scene.gpuBudget = bytes;
+                else if (keyword == "texture_budget") scene.textureBudget = bytes;
+                else scene.cpuBudget = bytes;
+            }
+            else if (keyword == "baked") {
+                readWord(scene.bakedLightingPath);
+            }
+            else if (keyword == "room") {
+                RoomDescription room;
+                readWord(room.name);
+                std::string key;
+                while (tokens >> key) {
+                    if (key == "center") readVec3(room.center);
+                    else if (key == "size") readVec3(room.size);
+                    else if (key == "yaw") { if (!(tokens >> room.yaw)) fail("expected an angle"); }
+                    else fail("unknown room attribute " + key);
+                }
+                if (scene.findRoom(room.name) >= 0) fail("duplicate room " + room.name);
+                scene.rooms.push_back(room);
+            }
+            else if (keyword == "connect") {
+                std::string a, b;
+                readWord(a);
+                readWord(b);
+                int first = roomIndex(a);
+                int second = roomIndex(b);
+                scene.rooms[first].neighbours.push_back(second);
+                scene.rooms[second].neighbours.push_back(first);
+            }
+            else if (keyword == "model") {
+                ModelDescription model;
+                readWord(model.objPath);
+                readWord(model.mtlBaseDir);
+                std::string key;
+                while (tokens >> key) {
+                    if (key == "room") {
+                        std::string room;
+                        readWord(room);
+                        model.room = roomIndex(room);
+                    }
+                    else if (key == "name") readWord(model.name);
+                    else if (key == "position") readVec3(model.position);
+                    else if (key == "rotation") readVec3(model.rotation);
+                    else if (key == "scale") {
+                        // One number for uniform scale, three for per axis.
+                        if (!(tokens >> model.scale.x)) fail("expected a scale");
+                        model.scale = glm::vec3(model.scale.x);
+                        float y, z;
+                        std::streampos mark = tokens.tellg();
+                        if (tokens >> y >> z) {
+                            model.scale.y = y;
+                            model.scale.z = z;
+                        }
+                        else {
+                            tokens.clear();
+                            tokens.seekg(mark);
+                        }
+                    }
+                    else if (key == "tag") {
+                        std::string tag;
+                        readWord(tag);
+                        model.tags.push_back(tag);
+                    }
+                    else if (key == "required") model.required = true;
+                    else if (key == "static") model.exhibit = false;
+                    else if (key == "occluder") model.occluder = true;
+                    else fail("unknown model attribute " + key);
+                }
+                scene.models.push_back(model);
+            }
+            else if (keyword == "light") {
+                Light light;
+                std::string key;
+                while (tokens >> key) {
+                    if (key == "position") readVec3(light.position);
+                    else if (key == "ambient") readVec3(light.ambient);
+                    else if (key == "diffuse") readVec3(light.diffuse);
+                    else if (key == "specular") readVec3(light.specular);
+                    else if (key == "attenuation") {
+                        if (!(tokens >> light.constant >> light.linear >> light.quadratic)) fail("expected three numbers");
+                    }
+                    else fail("unknown light attribute " + key);
+                }
+                scene.lights.push_back(light);
+            }
+            else {
+                fail("unknown keyword " + keyword);
+            }
+        }
+        return scene;
+    }
+};
\ No newline at end of file
@@ -6,10 +6,55 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "ProgramBinaryCache.h"
 
 class Shader {
 private:
     GLuint programID;
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    // Resolves every active uniform once after linking so lookups never need the GL
+    // context and can be made from recording threads.
+    void cacheUniformLocations() {
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::string name(maxLength > 0 ? maxLength : 1, '\0');
+        for (GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(programID, i, maxLength, &length, &size, &type, &name[0]);
+
+            std::string uniformName = name.substr(0, length);
+            uniformLocations[uniformName] = glGetUniformLocation(programID, uniformName.c_str());
+
+            // Arrays are reported once as "name[0]"; also register the bare name and
+            // every other element, whose locations need not be consecutive.
+            size_t bracket = uniformName.find("[0]");
+            if (bracket != std::string::npos) {
+                std::string base = uniformName.substr(0, bracket);
+                uniformLocations[base] = uniformLocations[uniformName];
+                if (bracket + 3 == uniformName.size()) {
+                    for (GLint element = 1; element < size; element++) {
+                        std::string elementName = base + "[" + std::to_string(element) + "]";
+                        uniformLocations[elementName] = glGetUniformLocation(programID, elementName.c_str());
+                    }
+                }
+            }
+        }
+    }
+
+    GLuint vertexShader = 0;
+    GLuint fragmentShader = 0;
+    std::string name;
+    std::string cacheKey;
+    const ProgramBinaryCache* cache = nullptr;
+    bool ready = false;
 
     std::string loadShaderCode(const char* path) {
         std::ifstream shaderFile(path);
@@ -22,46 +67,143 @@ private:
         return shaderStream.str();
     }
 
+    // Permutation defines go right after the #version line, which must stay first.
+    static std::string injectDefines(const std::string& source, const std::string& defines) {
+        if (defines.empty()) return source;
+
+        size_t versionLine = source.find("#version");
+        if (versionLine == std::string::npos) {
+            return defines + source;
+        }
+        size_t lineEnd = source.find('\n', versionLine);
+        if (lineEnd == std::string::npos) {
+            return source + "\n" + defines;
+        }
+        return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+    }
+
+    static std::string getShaderLog(GLuint shader) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length > 0 ? length : 1, '\0');
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), NULL, &log[0]);
+        return log;
+    }
+
+    static std::string getProgramLog(GLuint program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length > 0 ? length : 1, '\0');
+        glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), NULL, &log[0]);
+        return log;
+    }
+
+    static GLuint compile(GLenum type, const std::string& code) {
+        const char* source = code.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
 public:
-    Shader(const char* vertexPath, const char* fragmentPath) {
-        std::string vertexCode = loadShaderCode(vertexPath);
-        std::string fragmentCode = loadShaderCode(fragmentPath);
+    // Builds the program synchronously.
+    Shader(const char* vertexPath, const char* fragmentPath,
+        const std::vector<std::string>& defines = std::vector<std::string>(),
+        const ProgramBinaryCache* cache = nullptr)
+        : Shader(vertexPath, fragmentPath, defines, cache, true) {
+    }
 
-        const char* vertexSource = vertexCode.c_str();
-        const char* fragmentSource = fragmentCode.c_str();
+    // With finalizeNow == false this only issues the compile and link (or the cached
+    // binary upload) and returns; the driver can compile in the background (more so
+    // with ARB_parallel_shader_compile) until finalize() collects the result.
+    Shader(const char* vertexPath, const char* fragmentPath,
+        const std::vector<std::string>& defines,
+        const ProgramBinaryCache* cache,
+        bool finalizeNow) : cache(cache) {
+        std::string defineBlock;
+        for (const auto& define : defines) {
+            defineBlock += "#define " + define + "\n";
+        }
 
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexSource, NULL);
-        glCompileShader(vertexShader);
+        std::string vertexCode = injectDefines(loadShaderCode(vertexPath), defineBlock);
+        std::string fragmentCode = injectDefines(loadShaderCode(fragmentPath), defineBlock);
+        name = std::string(vertexPath) + " + " + fragmentPath;
+        if (!defines.empty()) {
+            name += " [" + defineBlock.substr(0, defineBlock.size() - 1) + "]";
+        }
+
+        programID = glCreateProgram();
+
+        if (cache) {
+            cacheKey = cache->makeKey(vertexCode, fragmentCode, defineBlock);
+            if (cache->load(cacheKey, programID)) {
+                cacheUniformLocations();
+                ready = true;
+                return;
+            }
+            glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        vertexShader = compile(GL_VERTEX_SHADER, vertexCode);
+        fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentCode);
+
+        glAttachShader(programID, vertexShader);
+        glAttachShader(programID, fragmentShader);
+        glLinkProgram(programID);
+
+        if (finalizeNow) {
+            finalize();
+        }
+    }
+
+    // Returns true once finalize() would not block.
+    bool isCompileComplete() const {
+        if (ready) return true;
+        if (!GLEW_ARB_parallel_shader_compile && !GLEW_KHR_parallel_shader_compile) return true;
+
+        GLint complete = GL_TRUE;
+        glGetProgramiv(programID, GL_COMPLETION_STATUS_ARB, &complete);
+        return complete == GL_TRUE;
+    }
+
+    // Waits for the link, reports errors with the full driver log, stores the binary in
+    // the cache and resolves uniform locations.
+    void finalize() {
+        if (ready) return;
+        ready = true;
 
         GLint success;
         glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
         if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-            std::cerr << "Vertex shader compilation failed: " << infoLog << std::endl;
+            std::cerr << "Vertex shader compilation failed (" << name << "): " << getShaderLog(vertexShader) << std::endl;
         }
 
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
-        glCompileShader(fragmentShader);
-
         glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
         if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-            std::cerr << "Fragment shader compilation failed: " << infoLog << std::endl;
+            std::cerr << "Fragment shader compilation failed (" << name << "): " << getShaderLog(fragmentShader) << std::endl;
         }
 
-        programID = glCreateProgram();
-        glAttachShader(programID, vertexShader);
-        glAttachShader(programID, fragmentShader);
-        glLinkProgram(programID);
+        glGetProgramiv(programID, GL_LINK_STATUS, &success);
+        if (!success) {
+            std::cerr << "Shader program linking failed (" << name << "): " << getProgramLog(programID) << std::endl;
+        }
+        else if (cache) {
+            cache->store(cacheKey, programID);
+        }
 
+        glDetachShader(programID, vertexShader);
+        glDetachShader(programID, fragmentShader);
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
+        vertexShader = 0;
+        fragmentShader = 0;
+
+        cacheUniformLocations();
     }
 
+    bool isReady() const { return ready; }
+
     ~Shader() {
         glDeleteProgram(programID);
     }
@@ -70,8 +212,13 @@ public:
         glUseProgram(programID);
     }
 
+    GLint getUniformLocation(const std::string& name) const {
+        auto it = uniformLocations.find(name);
+        return it != uniformLocations.end() ? it->second : -1;
+    }
+
     void setInt(const std::string& name, int value) {
-        GLint location = glGetUniformLocation(programID, name.c_str());
+        GLint location = getUniformLocation(name);
         if (location == -1) {
             std::cerr << "Uniform " << name << " nu a fost găsit în shader!" << std::endl;
         }
@@ -81,15 +228,15 @@ public:
     }
 
     void setFloat(const std::string& name, float value) {
-        glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
+        glUniform1f(getUniformLocation(name), value);
     }
 
     void setMat4(const std::string& name, const glm::mat4& matrix) {
-        glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
     }
 
     void setVec3(const std::string& name, const glm::vec3& value) {
-        GLint location = glGetUniformLocation(programID, name.c_str());
+        GLint location = getUniformLocation(name);
         if (location == -1) {
             std::cerr << "Uniform " << name << " nu a fost găsit în shader!" << std::endl;
         }
@@ -0,0 +1 @@
+#include "ShaderLibrary.h"
\ No newline at end of file
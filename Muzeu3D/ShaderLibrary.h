@@ -0,0 +1,53 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+#include "ProgramBinaryCache.h"
+
+// Owns every shader variant. request() only starts compiling a variant so the driver
+// can work on all of them while the scene loads; finalizeAll() collects the results.
+class ShaderLibrary {
+private:
+    ProgramBinaryCache cache;
+    std::unordered_map<std::string, std::unique_ptr<Shader>> variants;
+
+public:
+    ShaderLibrary(const std::string& cacheDirectory = "../ShaderCache/") : cache(cacheDirectory) {
+    }
+
+    Shader* request(const char* vertexPath, const char* fragmentPath,
+        const std::vector<std::string>& defines = std::vector<std::string>()) {
+        std::string key = std::string(vertexPath) + "|" + fragmentPath;
+        for (const auto& define : defines) {
+            key += "|" + define;
+        }
+
+        auto it = variants.find(key);
+        if (it != variants.end()) {
+            return it->second.get();
+        }
+
+        auto shader = std::make_unique<Shader>(vertexPath, fragmentPath, defines, &cache, false);
+        Shader* result = shader.get();
+        variants.emplace(key, std::move(shader));
+        return result;
+    }
+
+    // Like request(), but the returned shader is ready to use.
+    Shader* get(const char* vertexPath, const char* fragmentPath,
+        const std::vector<std::string>& defines = std::vector<std::string>()) {
+        Shader* shader = request(vertexPath, fragmentPath, defines);
+        shader->finalize();
+        return shader;
+    }
+
+    void finalizeAll() {
+        for (auto& variant : variants) {
+            variant.second->finalize();
+        }
+    }
+
+    size_t getVariantCount() const { return variants.size(); }
+};
\ No newline at end of file
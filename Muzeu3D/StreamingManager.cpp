@@ -0,0 +1 @@
+#include "StreamingManager.h"
\ No newline at end of file
@@ -0,0 +1,414 @@
+#pragma once
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BakedLighting.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "RenderCommandList.h"
+#include "RenderStats.h"
+#include "ResourceRegistry.h"
+#include "SceneDescription.h"
+
+// Keeps the models of the visitor's room and its neighbours resident. Models are
+// parsed on the job system, uploaded and deleted by tasks queued into the next
+// command list (so GL work stays on the render thread) and never exceed the memory
+// budget of the scene file; when they would, models of neighbouring rooms go first.
+// Neighbouring rooms are also not prefetched while GPU memory is over its budget.
+class StreamingManager {
+private:
+    enum class State {
+        Unloaded,
+        Loading,        // parsing on a worker
+        Uploading,      // upload task queued for the GL thread
+        Resident
+    };
+
+    struct Entry {
+        State state = State::Unloaded;
+        std::shared_ptr<Model> model;
+        std::vector<glm::vec3> occluderTriangles;   // world space
+        uint64_t occluderResourceId = 0;
+        size_t bytes = 0;
+        bool rejected = false;      // failed or did not fit; retried after a room change
+    };
+
+    struct ParsedModel {
+        size_t index;
+        std::shared_ptr<ModelData> data;
+        std::string error;
+    };
+
+    static const int NOT_WANTED = 3;
+    const int MAX_LOADS_IN_FLIGHT = 2;
+    static const size_t MAX_OCCLUDER_TRIANGLES = 6000;
+
+    JobSystem& jobs;
+    const SceneDescription& scene;
+    RenderStats& stats;
+    const BakedLighting* baked;
+    std::vector<Entry> entries;
+    int currentRoom = -1;
+    size_t residentBytes = 0;
+    size_t uploadingBytes = 0;
+    int loadsInFlight = 0;
+    JobCounter loadCounter;
+
+    std::mutex mutex;
+    std::vector<ParsedModel> parsed;                                    // written by workers
+    std::vector<std::pair<size_t, std::shared_ptr<Model>>> uploaded;   // written by the GL thread
+    std::vector<std::function<void()>> gpuTasks;
+
+    // 0 = always resident, 1 = current room, 2 = neighbour, NOT_WANTED otherwise.
+    int priorityOf(size_t index) const {
+        int room = scene.models[index].room;
+        if (room < 0 || currentRoom < 0) return room < 0 ? 0 : 1;
+        if (room == currentRoom) return 1;
+        const auto& neighbours = scene.rooms[currentRoom].neighbours;
+        if (std::find(neighbours.begin(), neighbours.end(), room) != neighbours.end()) return 2;
+        return NOT_WANTED;
+    }
+
+    static std::string modelNameFromPath(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        size_t start = slash == std::string::npos ? 0 : slash + 1;
+        size_t dot = path.find_last_of('.');
+        return path.substr(start, dot == std::string::npos || dot < start ? std::string::npos : dot - start);
+    }
+
+    static std::string displayName(const ModelDescription& desc) {
+        return desc.name.empty() ? modelNameFromPath(desc.objPath) : desc.name;
+    }
+
+    void setOccluderTriangles(size_t index, std::vector<glm::vec3> triangles) {
+        Entry& entry = entries[index];
+        ResourceRegistry::global().release(entry.occluderResourceId);
+        entry.occluderResourceId = 0;
+        entry.occluderTriangles = std::move(triangles);
+        if (!entry.occluderTriangles.empty()) {
+            entry.occluderResourceId = ResourceRegistry::global().track(ResourceCategory::Occluders,
+                displayName(scene.models[index]), entry.occluderTriangles.capacity() * sizeof(glm::vec3));
+        }
+    }
+
+    // Must run on the thread that owns the GL context.
+    static std::shared_ptr<Model> createModel(const ModelDescription& desc, const ModelData& data) {
+        auto model = std::make_shared<Model>(data, displayName(desc));
+        model->setPosition(desc.position);
+        model->setRotation(desc.rotation);
+        model->setScale(desc.scale);
+        model->setExhibit(desc.exhibit);
+        model->setOccluder(desc.occluder);
+        return model;
+    }
+
+    std::vector<glm::vec3> extractOccluderTriangles(const ModelDescription& desc, const ModelData& data) const {
+        std::vector<glm::vec3> triangles;
+        if (!desc.occluder) return triangles;
+
+        size_t count = 0;
+        for (const auto& mesh : data.meshes) {
+            count += mesh.indices.size() / 3;
+        }
+        if (count > MAX_OCCLUDER_TRIANGLES) {
+            std::cerr << "Occluder " << desc.objPath << " has " << count << " triangles, not used for occlusion culling\n";
+            return triangles;
+        }
+
+        glm::mat4 modelMatrix = Model::composeMatrix(desc.position, desc.rotation, desc.scale);
+
+        triangles.reserve(count * 3);
+        for (const auto& mesh : data.meshes) {
+            for (GLuint index : mesh.indices) {
+                const GLfloat* vertex = &mesh.vertices[index * 8];
+                triangles.push_back(glm::vec3(modelMatrix * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f)));
+            }
+        }
+        return triangles;
+    }
+
+    // Evicts resident models less important than priority until bytes fit the budget.
+    bool makeRoom(size_t bytes, int priority) {
+        while (residentBytes + uploadingBytes + bytes > scene.memoryBudget) {
+            int victim = -1;
+            int victimPriority = priority;
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (entries[i].state != State::Resident) continue;
+                int p = priorityOf(i);
+                if (p > victimPriority) {
+                    victim = static_cast<int>(i);
+                    victimPriority = p;
+                }
+            }
+            if (victim < 0) {
+                return false;
+            }
+            evict(victim);
+            entries[victim].rejected = true;
+        }
+        return true;
+    }
+
+    // The model is destroyed by a GL task; callers must drop their references first.
+    void evict(size_t index) {
+        Entry& entry = entries[index];
+        std::shared_ptr<Model> model = std::move(entry.model);
+        gpuTasks.push_back([model]() mutable { model.reset(); });
+
+        residentBytes -= entry.bytes;
+        entry.state = State::Unloaded;
+        setOccluderTriangles(index, {});
+        stats.modelsEvicted++;
+    }
+
+    // Gives a static model the lightmap coordinates baked for it. A bake that no longer
+    // matches the geometry is ignored, and the model is lit in real time.
+    void attachLightmap(size_t index, ModelData& data) const {
+        const BakedLighting::ModelLightmap* lightmap = baked ? baked->findModel(index) : nullptr;
+        if (!lightmap) return;
+
+        bool matches = lightmap->meshCoords.size() == data.meshes.size();
+        for (size_t m = 0; matches && m < data.meshes.size(); m++) {
+            matches = lightmap->meshCoords[m].size() == data.meshes[m].vertices.size() / 8 * 2;
+        }
+        if (!matches) {
+            std::cerr << "Baked lighting does not match " << scene.models[index].objPath << ", run LightmapBaker again\n";
+            return;
+        }
+        for (size_t m = 0; m < data.meshes.size(); m++) {
+            data.meshes[m].lightmapCoords = lightmap->meshCoords[m];
+        }
+    }
+
+    // Parsed data counts as staging memory until its last reference, normally the
+    // upload task, lets go of it.
+    static std::shared_ptr<ModelData> stage(const ModelDescription& desc, ModelData&& data) {
+        uint64_t id = ResourceRegistry::global().track(ResourceCategory::StagingData, displayName(desc), data.getMemorySize());
+        return std::shared_ptr<ModelData>(new ModelData(std::move(data)), [id](ModelData* staged) {
+            delete staged;
+            ResourceRegistry::global().release(id);
+        });
+    }
+
+    void startLoad(size_t index) {
+        entries[index].state = State::Loading;
+        loadsInFlight++;
+        jobs.run([this, index] {
+            ParsedModel result{ index, nullptr, "" };
+            try {
+                const ModelDescription& desc = scene.models[index];
+                ModelData data = ModelData::load(desc.objPath.c_str(), desc.mtlBaseDir.c_str(), &jobs);
+                attachLightmap(index, data);
+                result.data = stage(desc, std::move(data));
+            }
+            catch (const std::exception& e) {
+                result.error = e.what();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            parsed.push_back(std::move(result));
+        }, &loadCounter);
+    }
+
+    // Loads of required models fail loudly on both paths; anything else is skipped.
+    void loadFailed(size_t index, const std::string& error) {
+        const ModelDescription& desc = scene.models[index];
+        if (desc.required) {
+            throw std::runtime_error("Failed to load required model " + desc.objPath + ": " + error);
+        }
+        std::cerr << "Error loading model: " << desc.objPath << "\nException: " << error << "\n";
+        entries[index].rejected = true;
+    }
+
+    void updateResidentStats() {
+        stats.residentModelBytes = residentBytes;
+    }
+
+public:
+    // baked may be null; it must outlive the manager.
+    StreamingManager(JobSystem& jobs, const SceneDescription& scene, RenderStats& stats, const BakedLighting* baked = nullptr)
+        : jobs(jobs), scene(scene), stats(stats), baked(baked), entries(scene.models.size()) {
+    }
+
+    ~StreamingManager() {
+        jobs.wait(loadCounter);
+        for (size_t i = 0; i < entries.size(); i++) {
+            setOccluderTriangles(i, {});
+        }
+    }
+
+    // Synchronously loads what the visitor needs at position; used at startup while
+    // this thread still owns the GL context. Required models that fail throw.
+    void loadNow(const glm::vec3& position) {
+        currentRoom = scene.roomAt(position);
+
+        std::vector<size_t> wanted;
+        for (int priority = 0; priority < NOT_WANTED; priority++) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (entries[i].state == State::Unloaded && priorityOf(i) == priority) {
+                    wanted.push_back(i);
+                }
+            }
+        }
+
+        std::vector<ModelData> loaded(wanted.size());
+        std::vector<std::string> errors(wanted.size());
+        jobs.parallelFor(wanted.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const ModelDescription& desc = scene.models[wanted[i]];
+                try {
+                    loaded[i] = ModelData::load(desc.objPath.c_str(), desc.mtlBaseDir.c_str(), &jobs);
+                    attachLightmap(wanted[i], loaded[i]);
+                }
+                catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+        });
+
+        for (size_t i = 0; i < wanted.size(); i++) {
+            size_t index = wanted[i];
+            const ModelDescription& desc = scene.models[index];
+            Entry& entry = entries[index];
+            if (!errors[i].empty()) {
+                loadFailed(index, errors[i]);
+                continue;
+            }
+
+            size_t bytes = loaded[i].getMemorySize();
+            if (!makeRoom(bytes, priorityOf(index))) {
+                std::cerr << "Memory budget exceeded, not loading " << desc.objPath << "\n";
+                entry.rejected = true;
+                stats.modelsRejected++;
+                continue;
+            }
+
+            entry.model = createModel(desc, loaded[i]);
+            setOccluderTriangles(index, extractOccluderTriangles(desc, loaded[i]));
+            entry.bytes = bytes;
+            entry.state = State::Resident;
+            residentBytes += bytes;
+            stats.modelsStreamedIn++;
+            std::cout << "Loaded model: " << desc.objPath << "\n";
+        }
+        updateResidentStats();
+    }
+
+    // Advances streaming for the visitor at position. Returns true when the set of
+    // resident models changed. A required model that fails to load throws.
+    bool update(const glm::vec3& position) {
+        int room = scene.roomAt(position);
+        if (room >= 0 && room != currentRoom) {
+            currentRoom = room;
+            std::cout << "Entering " << scene.rooms[room].name << "\n";
+            for (Entry& entry : entries) {
+                entry.rejected = false;
+            }
+        }
+
+        bool changed = false;
+        std::vector<std::pair<size_t, std::shared_ptr<Model>>> newlyUploaded;
+        std::vector<ParsedModel> newlyParsed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            newlyUploaded.swap(uploaded);
+            newlyParsed.swap(parsed);
+        }
+
+        for (auto& upload : newlyUploaded) {
+            Entry& entry = entries[upload.first];
+            entry.model = std::move(upload.second);
+            entry.state = State::Resident;
+            uploadingBytes -= entry.bytes;
+            residentBytes += entry.bytes;
+            stats.modelsStreamedIn++;
+            changed = true;
+        }
+
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].state == State::Resident && priorityOf(i) == NOT_WANTED) {
+                evict(i);
+                changed = true;
+            }
+        }
+
+        for (auto& result : newlyParsed) {
+            loadsInFlight--;
+            Entry& entry = entries[result.index];
+            const ModelDescription& desc = scene.models[result.index];
+            entry.state = State::Unloaded;
+
+            if (!result.error.empty()) {
+                loadFailed(result.index, result.error);
+                continue;
+            }
+            int priority = priorityOf(result.index);
+            if (priority == NOT_WANTED) {
+                continue;
+            }
+
+            size_t bytes = result.data->getMemorySize();
+            size_t residentBefore = residentBytes;
+            if (!makeRoom(bytes, priority)) {
+                std::cerr << "Memory budget exceeded, not loading " << desc.objPath << "\n";
+                entry.rejected = true;
+                stats.modelsRejected++;
+                continue;
+            }
+            changed = changed || residentBytes != residentBefore;
+
+            setOccluderTriangles(result.index, extractOccluderTriangles(desc, *result.data));
+            entry.bytes = bytes;
+            entry.state = State::Uploading;
+            uploadingBytes += bytes;
+
+            size_t index = result.index;
+            std::shared_ptr<ModelData> data = std::move(result.data);
+            gpuTasks.push_back([this, index, data]() mutable {
+                std::shared_ptr<Model> model = createModel(scene.models[index], *data);
+                data.reset();
+                std::lock_guard<std::mutex> lock(mutex);
+                uploaded.emplace_back(index, std::move(model));
+            });
+        }
+
+        int lastPriority = ResourceRegistry::global().isGpuOverBudget() ? 2 : NOT_WANTED;
+        for (int priority = 0; priority < lastPriority && loadsInFlight < MAX_LOADS_IN_FLIGHT; priority++) {
+            for (size_t i = 0; i < entries.size() && loadsInFlight < MAX_LOADS_IN_FLIGHT; i++) {
+                if (entries[i].state == State::Unloaded && !entries[i].rejected && priorityOf(i) == priority) {
+                    startLoad(i);
+                }
+            }
+        }
+
+        updateResidentStats();
+        return changed;
+    }
+
+    // Hands queued uploads and deletes to the GL thread, in front of this frame's draws.
+    void recordGpuWork(RenderCommandList& list) {
+        for (auto& task : gpuTasks) {
+            list.runTask(std::move(task));
+        }
+        gpuTasks.clear();
+    }
+
+    bool hasPendingGpuWork() const { return !gpuTasks.empty(); }
+
+    // Loads, uploads or deletes under way; frames allocate while this is true.
+    bool isBusy() const { return loadsInFlight > 0 || uploadingBytes > 0 || !gpuTasks.empty(); }
+
+    // callback(const ModelDescription&, const std::shared_ptr<Model>&, const std::vector<glm::vec3>& occluderTriangles)
+    // for every resident model, in scene file order.
+    template <typename Callback>
+    void forEachResident(Callback callback) const {
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].state == State::Resident) {
+                callback(scene.models[i], entries[i].model, entries[i].occluderTriangles);
+            }
+        }
+    }
+};
\ No newline at end of file
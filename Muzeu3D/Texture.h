@@ -1,64 +1,212 @@
 #pragma once
 #include <GL/glew.h>
 #include <stb_image.h>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <vector>
+#include "ResourceRegistry.h"
 
+// Decoded image on the CPU, either the full image or one of its mip levels. Nothing
+// here touches GL, so it can run on a worker thread.
+struct TextureData {
+    // Largest level uploaded with a model; finer levels are streamed in on demand.
+    static const int STREAMING_START_SIZE = 256;
+
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    int level = 0;                  // mip level held in pixels
+    int fullWidth = 0;              // of level 0
+    int fullHeight = 0;
+    std::unique_ptr<unsigned char, void(*)(void*)> pixels{ nullptr, stbi_image_free };
+
+    static TextureData load(const char* path) {
+        stbi_set_flip_vertically_on_load_thread(true);
+
+        TextureData data;
+        data.path = path;
+        data.pixels.reset(stbi_load(path, &data.width, &data.height, &data.channels, 0));
+        if (!data.pixels) {
+            throw std::runtime_error(std::string("Failed to load texture: ") + path);
+        }
+        if (data.channels != 1 && data.channels != 3 && data.channels != 4) {
+            throw std::runtime_error("Unsupported number of channels");
+        }
+        data.fullWidth = data.width;
+        data.fullHeight = data.height;
+        return data;
+    }
+
+    // The next mip level, box filtered (edge texels repeat for odd sizes).
+    TextureData halved() const {
+        TextureData result;
+        result.path = path;
+        result.width = std::max(1, width / 2);
+        result.height = std::max(1, height / 2);
+        result.channels = channels;
+        result.level = level + 1;
+        result.fullWidth = fullWidth;
+        result.fullHeight = fullHeight;
+        result.pixels = std::unique_ptr<unsigned char, void(*)(void*)>(
+            static_cast<unsigned char*>(std::malloc(static_cast<size_t>(result.width) * result.height * channels)), std::free);
+        if (!result.pixels) {
+            throw std::runtime_error("Out of memory downsampling " + path);
+        }
+
+        for (int y = 0; y < result.height; y++) {
+            int y0 = std::min(y * 2, height - 1);
+            int y1 = std::min(y * 2 + 1, height - 1);
+            for (int x = 0; x < result.width; x++) {
+                int x0 = std::min(x * 2, width - 1);
+                int x1 = std::min(x * 2 + 1, width - 1);
+                for (int c = 0; c < channels; c++) {
+                    int sum = pixels.get()[(y0 * width + x0) * channels + c] + pixels.get()[(y0 * width + x1) * channels + c] +
+                        pixels.get()[(y1 * width + x0) * channels + c] + pixels.get()[(y1 * width + x1) * channels + c];
+                    result.pixels.get()[(y * result.width + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        return result;
+    }
+
+    // Halves until neither side exceeds maxSize.
+    TextureData reduced(int maxSize) && {
+        TextureData result = std::move(*this);
+        while (std::max(result.width, result.height) > maxSize) {
+            result = result.halved();
+        }
+        return result;
+    }
+};
+
+// GL texture with a partial mip chain: levels from the resident level down to 1x1 are
+// on the GPU, finer ones are added with uploadLevels() and dropped with evictTo(),
+// moving GL_TEXTURE_BASE_LEVEL along. GL methods run on the thread that owns the context.
 class Texture {
 private:
     GLuint textureID;
+    uint64_t resourceId = 0;
+    std::string path;
+    GLenum format;
+    int fullWidth;
+    int fullHeight;
+    int channels;
+    int levelCount;
+    int residentLevel;
+    int startLevel;
+
+    size_t chainBytes(int level) const {
+        // Drivers usually pad RGB to four bytes.
+        size_t texelBytes = channels == 3 ? 4 : static_cast<size_t>(channels);
+        size_t bytes = 0;
+        for (int i = level; i < levelCount; i++) {
+            bytes += static_cast<size_t>(std::max(1, fullWidth >> i)) * std::max(1, fullHeight >> i) * texelBytes;
+        }
+        return bytes;
+    }
+
+    void setBaseLevel(int level) {
+        residentLevel = level;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        ResourceRegistry::global().resize(resourceId, chainBytes(level));
+    }
 
 public:
-    Texture(const char* path) {
+    Texture(const char* path) : Texture(TextureData::load(path), path) {
+    }
+
+    // data may hold a mip level instead of the full image; the coarser levels are
+    // generated from it. owner names the model (or file) in the resource registry.
+    Texture(const TextureData& data, const std::string& owner = "unnamed texture")
+        : path(data.path), fullWidth(data.fullWidth), fullHeight(data.fullHeight), channels(data.channels),
+        residentLevel(data.level), startLevel(data.level) {
         glGenTextures(1, &textureID);
 
-        stbi_set_flip_vertically_on_load(true);
-
-        int width, height, channels;
-        unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
-
-        if (data) {
-            GLenum format;
-            if (channels == 1)
-                format = GL_RED;
-            else if (channels == 3)
-                format = GL_RGB;
-            else if (channels == 4)
-                format = GL_RGBA;
-            else {
-                stbi_image_free(data);
-                throw std::runtime_error("Unsupported number of channels");
-            }
+        if (data.channels == 1)
+            format = GL_RED;
+        else if (data.channels == 3)
+            format = GL_RGB;
+        else
+            format = GL_RGBA;
 
-            glBindTexture(GL_TEXTURE_2D, textureID);
+        levelCount = 1;
+        for (int size = std::max(fullWidth, fullHeight); size > 1; size >>= 1) {
+            levelCount++;
+        }
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, textureID);
 
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, data.level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
 
-            float maxAniso = 0.0f;
-            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, data.level, format, data.width, data.height, 0, format, GL_UNSIGNED_BYTE, data.pixels.get());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
 
-            stbi_image_free(data);
-        }
-        else {
-            throw std::runtime_error(std::string("Failed to load texture: ") + path);
-        }
+        float maxAniso = 0.0f;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
+
+        resourceId = ResourceRegistry::global().track(ResourceCategory::Texture, owner, chainBytes(data.level));
     }
 
     ~Texture() {
         glDeleteTextures(1, &textureID);
+        ResourceRegistry::global().release(resourceId);
     }
 
+    // levels holds consecutive mip levels, finest first, ending just above the
+    // resident level.
+    void uploadLevels(const std::vector<TextureData>& levels) {
+        if (levels.empty() || levels.back().level + 1 != residentLevel) return;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (const TextureData& data : levels) {
+            glTexImage2D(GL_TEXTURE_2D, data.level, format, data.width, data.height, 0, format, GL_UNSIGNED_BYTE, data.pixels.get());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        setBaseLevel(levels.front().level);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Frees the levels finer than level.
+    void evictTo(int level) {
+        level = std::min(level, startLevel);
+        if (level <= residentLevel) return;
+
+        int previous = residentLevel;
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        setBaseLevel(level);
+        for (int i = previous; i < level; i++) {
+            glTexImage2D(GL_TEXTURE_2D, i, format, 0, 0, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
     void bind(GLuint unit = 0) {
         glActiveTexture(GL_TEXTURE0 + unit);
         glBindTexture(GL_TEXTURE_2D, textureID);
     }
 
     GLuint getID() const { return textureID; }
+    const std::string& getPath() const { return path; }
+    int getWidth() const { return fullWidth; }
+    int getHeight() const { return fullHeight; }
+    int getChannels() const { return channels; }
+    int getStartLevel() const { return startLevel; }
+    int getResidentLevel() const { return residentLevel; }
 };
\ No newline at end of file
@@ -0,0 +1 @@
+#include "TextureStreamer.h"
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.h"
+#include "MipStreamingPolicy.h"
+#include "Model.h"
+#include "RenderCommandList.h"
+#include "RenderStats.h"
+
+// Streams the finer mip levels of the resident models' textures. Models upload their
+// textures at TextureData::STREAMING_START_SIZE; each frame the scene reports how
+// large the visible models appear, MipStreamingPolicy picks the levels, images are
+// decoded again and downsampled on the job system, and uploads and evictions run as
+// tasks at the start of the next command list.
+class TextureStreamer {
+private:
+    struct Entry {
+        std::weak_ptr<Texture> texture;
+        bool failed = false;
+    };
+
+    // Results are found by address, but a texture freed while its load was running can
+    // have its address reused by a new one; texture tells the two apart.
+    struct LoadResult {
+        const Texture* key;
+        std::weak_ptr<Texture> texture;
+        std::shared_ptr<std::vector<TextureData>> levels;
+        std::string error;
+    };
+
+    struct Upload {
+        const Texture* key;
+        std::weak_ptr<Texture> texture;
+        int level;
+    };
+
+    JobSystem& jobs;
+    RenderStats& stats;
+    MipStreamingPolicy policy;
+    std::vector<Entry> entries;
+    std::vector<MipStreamingPolicy::TextureState> states;
+    std::unordered_map<const Texture*, size_t> lookup;
+    uint64_t frame = 1;
+    int loadsInFlight = 0;
+    std::vector<MipStreamingPolicy::Change> changes;
+    JobCounter loadCounter;
+
+    std::mutex mutex;
+    std::vector<LoadResult> loaded;     // written by workers
+    std::vector<Upload> uploaded;       // written by the GL thread
+    std::vector<std::function<void()>> gpuTasks;
+
+    // Index of the entry for key if it still is the same texture object, otherwise -1.
+    int findEntry(const Texture* key, const std::weak_ptr<Texture>& texture) const {
+        auto it = lookup.find(key);
+        if (it == lookup.end()) return -1;
+        const std::weak_ptr<Texture>& current = entries[it->second].texture;
+        if (current.owner_before(texture) || texture.owner_before(current)) return -1;
+        return static_cast<int>(it->second);
+    }
+
+    // Decodes the image again and builds levels [level, residentLevel).
+    void startLoad(size_t index, int level) {
+        std::shared_ptr<Texture> texture = entries[index].texture.lock();
+        if (!texture) {
+            states[index].loading = false;
+            return;
+        }
+        const Texture* key = texture.get();
+        std::weak_ptr<Texture> weakTexture = texture;
+        std::string path = texture->getPath();
+        int residentLevel = states[index].residentLevel;
+
+        jobs.run([this, key, weakTexture, path, level, residentLevel] {
+            LoadResult result{ key, weakTexture, std::make_shared<std::vector<TextureData>>(), "" };
+            try {
+                TextureData data = TextureData::load(path.c_str());
+                while (data.level < level) {
+                    data = data.halved();
+                }
+                while (data.level < residentLevel) {
+                    TextureData next = data.halved();
+                    result.levels->push_back(std::move(data));
+                    data = std::move(next);
+                }
+            }
+            catch (const std::exception& e) {
+                result.error = e.what();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded.push_back(std::move(result));
+        }, &loadCounter);
+        loadsInFlight++;
+    }
+
+    void collectResults() {
+        std::vector<LoadResult> newlyLoaded;
+        std::vector<Upload> newlyUploaded;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            newlyLoaded.swap(loaded);
+            newlyUploaded.swap(uploaded);
+        }
+
+        loadsInFlight -= static_cast<int>(newlyUploaded.size());
+        for (const Upload& upload : newlyUploaded) {
+            int index = findEntry(upload.key, upload.texture);
+            if (index < 0) continue;
+            MipStreamingPolicy::finishLoad(states[index], upload.level);
+            stats.textureLevelsStreamedIn++;
+        }
+
+        for (auto& result : newlyLoaded) {
+            int index = findEntry(result.key, result.texture);
+            if (index < 0 || !result.error.empty() || result.levels->empty()) {
+                loadsInFlight--;
+            }
+            if (index < 0) continue;
+
+            // A texture that cannot be read again keeps the levels it has.
+            if (!result.error.empty() || result.levels->empty()) {
+                if (!result.error.empty()) {
+                    std::cerr << "Texture streaming failed: " << result.error << "\n";
+                }
+                entries[index].failed = true;
+                states[index].loading = false;
+                states[index].wantedLevel = states[index].residentLevel;
+                continue;
+            }
+
+            std::weak_ptr<Texture> texture = result.texture;
+            std::shared_ptr<std::vector<TextureData>> levels = std::move(result.levels);
+            const Texture* key = result.key;
+            gpuTasks.push_back([this, texture, levels, key]() mutable {
+                // Reports the level actually reached, in case the upload was refused.
+                int level = levels->back().level + 1;
+                if (std::shared_ptr<Texture> target = texture.lock()) {
+                    target->uploadLevels(*levels);
+                    level = target->getResidentLevel();
+                }
+                levels.reset();
+                std::lock_guard<std::mutex> lock(mutex);
+                uploaded.push_back(Upload{ key, texture, level });
+            });
+        }
+    }
+
+public:
+    TextureStreamer(JobSystem& jobs, RenderStats& stats, const MipStreamingSettings& settings = MipStreamingSettings())
+        : jobs(jobs), stats(stats), policy(settings) {
+    }
+
+    ~TextureStreamer() {
+        jobs.wait(loadCounter);
+    }
+
+    // Takes the textures of the resident models; state is kept for textures that stay.
+    void setTextures(const std::vector<std::shared_ptr<Model>>& models) {
+        std::vector<Entry> newEntries;
+        std::vector<MipStreamingPolicy::TextureState> newStates;
+        std::unordered_map<const Texture*, size_t> newLookup;
+
+        for (const auto& model : models) {
+            for (const auto& texture : model->getTextures()) {
+                const Texture* key = texture.get();
+                if (newLookup.count(key)) continue;
+                newLookup[key] = newEntries.size();
+
+                auto it = lookup.find(key);
+                if (it != lookup.end() && entries[it->second].texture.lock() == texture) {
+                    newEntries.push_back(entries[it->second]);
+                    newStates.push_back(states[it->second]);
+                    continue;
+                }
+
+                MipStreamingPolicy::TextureState state;
+                state.width = texture->getWidth();
+                state.height = texture->getHeight();
+                state.bytesPerTexel = texture->getChannels() == 3 ? 4 : texture->getChannels();
+                state.residentLevel = texture->getStartLevel();
+                state.coarsestLevel = texture->getStartLevel();
+                newEntries.push_back(Entry{ texture, false });
+                newStates.push_back(state);
+            }
+        }
+        entries.swap(newEntries);
+        states.swap(newStates);
+        lookup.swap(newLookup);
+    }
+
+    // projectedPixels: on-screen size of a visible model using texture.
+    void addFeedback(const Texture* texture, float projectedPixels) {
+        auto it = lookup.find(texture);
+        if (it == lookup.end() || entries[it->second].failed) return;
+        policy.addFeedback(states[it->second], projectedPixels, frame);
+    }
+
+    // Applies this frame's feedback; the resulting GL work is recorded next frame.
+    void update() {
+        collectResults();
+
+        policy.plan(states, frame, changes);
+        for (const auto& change : changes) {
+            if (change.load) {
+                startLoad(change.texture, change.level);
+                continue;
+            }
+            std::weak_ptr<Texture> texture = entries[change.texture].texture;
+            int level = change.level;
+            gpuTasks.push_back([texture, level] {
+                if (std::shared_ptr<Texture> target = texture.lock()) {
+                    target->evictTo(level);
+                }
+            });
+            stats.textureLevelsEvicted++;
+        }
+
+        stats.streamedTextureBytes = MipStreamingPolicy::residentBytes(states);
+        frame++;
+    }
+
+    // Hands queued uploads and evictions to the GL thread, in front of this frame's draws.
+    void recordGpuWork(RenderCommandList& list) {
+        for (auto& task : gpuTasks) {
+            list.runTask(std::move(task));
+        }
+        gpuTasks.clear();
+    }
+
+    bool hasPendingGpuWork() const { return !gpuTasks.empty(); }
+
+    // Loads or GL work under way; frames allocate while this is true.
+    bool isBusy() const { return loadsInFlight > 0 || !gpuTasks.empty(); }
+};
\ No newline at end of file
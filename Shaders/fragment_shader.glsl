@@ -1,10 +1,41 @@
 #version 330 core
+// Permutations (injected after #version by Shader):
+//   LIGHT_COUNT  number of point lights, 0-3 (0 = lights off, ambient only)
+//   SHADOWS      1 to sample the shadow maps
+//   PCF_RADIUS   shadow filter radius in texels, (2r+1)^2 taps
+//   BAKED_LIGHTING  1 for lightmapped static geometry: albedo times the lightmap only
+//   PROBE_LIGHTING  1 to add indirect light from the model's irradiance probe
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 3
+#endif
+#ifndef SHADOWS
+#define SHADOWS 1
+#endif
+#ifndef PCF_RADIUS
+#define PCF_RADIUS 1
+#endif
+#ifndef BAKED_LIGHTING
+#define BAKED_LIGHTING 0
+#endif
+#ifndef PROBE_LIGHTING
+#define PROBE_LIGHTING 0
+#endif
+
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+#if BAKED_LIGHTING
+in vec2 LightmapCoord;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 1
 in vec4 FragPosLightSpace1;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 2
 in vec4 FragPosLightSpace2;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 3
 in vec4 FragPosLightSpace3;
+#endif
 
 out vec4 FragColor;
 
@@ -18,70 +49,120 @@ struct Light {
     float quadratic;
 };
 
+#if LIGHT_COUNT >= 1
 uniform Light light1;
+#endif
+#if LIGHT_COUNT >= 2
 uniform Light light2;
+#endif
+#if LIGHT_COUNT >= 3
 uniform Light light3;
+#endif
 uniform vec3 viewPos;
 uniform sampler2D texture_diffuse1;
+#if BAKED_LIGHTING
+uniform sampler2D lightmap;
+#endif
+#if PROBE_LIGHTING
+// Ambient cube: irradiance from +X, -X, +Y, -Y, +Z, -Z.
+uniform vec3 ambientCube[6];
+#endif
+#if SHADOWS && LIGHT_COUNT >= 1
 uniform sampler2D shadowMap1;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 2
 uniform sampler2D shadowMap2;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 3
 uniform sampler2D shadowMap3;
+#endif
 
 float ShadowCalculation(vec4 fragPosLightSpace, sampler2D shadowMap, vec3 lightPos) {
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
-    
+
     if(projCoords.z > 1.0)
         return 0.0;
-    
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
+
     float currentDepth = projCoords.z;
-    
+
     vec3 normal = normalize(Normal);
     vec3 lightDir = normalize(lightPos - FragPos);
     float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
-    
+
     float shadow = 0.0;
     vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-    for(int x = -1; x <= 1; ++x) {
-        for(int y = -1; y <= 1; ++y) {
+    for(int x = -PCF_RADIUS; x <= PCF_RADIUS; ++x) {
+        for(int y = -PCF_RADIUS; y <= PCF_RADIUS; ++y) {
             float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }
-    shadow /= 9.0;
-    
+    shadow /= float((2 * PCF_RADIUS + 1) * (2 * PCF_RADIUS + 1));
+
     return shadow;
 }
 
-vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow) {
+#if PROBE_LIGHTING
+vec3 ProbeIrradiance(vec3 normal) {
+    vec3 weights = normal * normal;
+    ivec3 negative = ivec3(lessThan(normal, vec3(0.0)));
+    return weights.x * ambientCube[negative.x] +
+        weights.y * ambientCube[negative.y + 2] +
+        weights.z * ambientCube[negative.z + 4];
+}
+#endif
+
+vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo, float shadow) {
     vec3 lightDir = normalize(light.position - fragPos);
     float diff = max(dot(normal, lightDir), 0.0);
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
-    
+
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-    
-    vec3 ambient = light.ambient * vec3(texture(texture_diffuse1, TexCoord));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture_diffuse1, TexCoord));
+
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * albedo;
     vec3 specular = light.specular * spec * vec3(0.5);
-    
+
     return ambient + (1.0 - shadow) * (diffuse + specular) * attenuation;
 }
 
 void main() {
+    vec3 albedo = vec3(texture(texture_diffuse1, TexCoord));
+
+#if BAKED_LIGHTING
+    FragColor = vec4(albedo * texture(lightmap, LightmapCoord).rgb, 1.0);
+#elif LIGHT_COUNT == 0
+    // Same result as the three dim ambient-only lights used before the permutations.
+    FragColor = vec4(0.15 * albedo, 1.0);
+#else
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
-    
-    float shadow1 = ShadowCalculation(FragPosLightSpace1, shadowMap1, light1.position);
-    float shadow2 = ShadowCalculation(FragPosLightSpace2, shadowMap2, light2.position);
-    float shadow3 = ShadowCalculation(FragPosLightSpace3, shadowMap3, light3.position);
-    
     vec3 result = vec3(0.0);
-    result += CalcPointLight(light1, norm, FragPos, viewDir, shadow1);
-    result += CalcPointLight(light2, norm, FragPos, viewDir, shadow2);
-    result += CalcPointLight(light3, norm, FragPos, viewDir, shadow3);
-    
+
+#if SHADOWS
+    result += CalcPointLight(light1, norm, FragPos, viewDir, albedo, ShadowCalculation(FragPosLightSpace1, shadowMap1, light1.position));
+#if LIGHT_COUNT >= 2
+    result += CalcPointLight(light2, norm, FragPos, viewDir, albedo, ShadowCalculation(FragPosLightSpace2, shadowMap2, light2.position));
+#endif
+#if LIGHT_COUNT >= 3
+    result += CalcPointLight(light3, norm, FragPos, viewDir, albedo, ShadowCalculation(FragPosLightSpace3, shadowMap3, light3.position));
+#endif
+#else
+    result += CalcPointLight(light1, norm, FragPos, viewDir, albedo, 0.0);
+#if LIGHT_COUNT >= 2
+    result += CalcPointLight(light2, norm, FragPos, viewDir, albedo, 0.0);
+#endif
+#if LIGHT_COUNT >= 3
+    result += CalcPointLight(light3, norm, FragPos, viewDir, albedo, 0.0);
+#endif
+#endif
+
+#if PROBE_LIGHTING
+    result += ProbeIrradiance(norm) * albedo;
+#endif
     FragColor = vec4(result, 1.0);
+#endif
 }
\ No newline at end of file
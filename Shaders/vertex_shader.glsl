@@ -1,30 +1,66 @@
 #version 330 core
+// Uses the same LIGHT_COUNT / SHADOWS / BAKED_LIGHTING permutation defines as fragment_shader.glsl.
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 3
+#endif
+#ifndef SHADOWS
+#define SHADOWS 1
+#endif
+#ifndef BAKED_LIGHTING
+#define BAKED_LIGHTING 0
+#endif
+
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
+#if BAKED_LIGHTING
+layout(location = 3) in vec2 aLightmapCoord;
+#endif
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
+#if BAKED_LIGHTING
+out vec2 LightmapCoord;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 1
 out vec4 FragPosLightSpace1;
+uniform mat4 lightSpaceMatrix1;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 2
 out vec4 FragPosLightSpace2;
+uniform mat4 lightSpaceMatrix2;
+#endif
+#if SHADOWS && LIGHT_COUNT >= 3
 out vec4 FragPosLightSpace3;
+uniform mat4 lightSpaceMatrix3;
+#endif
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat4 lightSpaceMatrix1;
-uniform mat4 lightSpaceMatrix2;
-uniform mat4 lightSpaceMatrix3;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
+#if LIGHT_COUNT > 0
     Normal = mat3(transpose(inverse(model))) * aNormal;
+#else
+    Normal = aNormal;
+#endif
     TexCoord = aTexCoord;
-    
+#if BAKED_LIGHTING
+    LightmapCoord = aLightmapCoord;
+#endif
+
+#if SHADOWS && LIGHT_COUNT >= 1
     FragPosLightSpace1 = lightSpaceMatrix1 * vec4(FragPos, 1.0);
+#endif
+#if SHADOWS && LIGHT_COUNT >= 2
     FragPosLightSpace2 = lightSpaceMatrix2 * vec4(FragPos, 1.0);
+#endif
+#if SHADOWS && LIGHT_COUNT >= 3
     FragPosLightSpace3 = lightSpaceMatrix3 * vec4(FragPos, 1.0);
-    
+#endif
+
     gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "Test.h"
+#include "BVH.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    const float WORLD = 50.0f;
+
+    struct Object {
+        int proxy = -1;     // -1 = destroyed
+        AABB box;
+    };
+
+    AABB randomBox(std::mt19937& random, const glm::vec3& center) {
+        std::uniform_real_distribution<float> size(0.1f, 2.0f);
+        glm::vec3 extent(size(random), size(random), size(random));
+        return AABB(center - extent, center + extent);
+    }
+
+    glm::vec3 randomPoint(std::mt19937& random) {
+        std::uniform_real_distribution<float> position(-WORLD, WORLD);
+        return glm::vec3(position(random), position(random), position(random));
+    }
+
+    // Objects the callback reported, one flag per user data; false if one came twice or
+    // does not exist.
+    struct Reported {
+        std::vector<bool> seen;
+        bool valid = true;
+
+        explicit Reported(size_t count) : seen(count, false) {
+        }
+
+        void add(const std::vector<Object>& objects, int userData) {
+            if (userData < 0 || userData >= static_cast<int>(seen.size()) || seen[userData] ||
+                objects[userData].proxy < 0) {
+                valid = false;
+                return;
+            }
+            seen[userData] = true;
+        }
+    };
+
+    // Every object matching the brute-force test has to be reported.
+    template <typename Test>
+    bool coversBruteForce(const std::vector<Object>& objects, const Reported& reported, Test test) {
+        if (!reported.valid) return false;
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (objects[i].proxy >= 0 && test(objects[i].box) && !reported.seen[i]) return false;
+        }
+        return true;
+    }
+
+    void checkQueries(std::mt19937& random, const BVH& tree, const std::vector<Object>& objects) {
+        AABB region = randomBox(random, randomPoint(random)).inflated(5.0f);
+        Reported overlapping(objects.size());
+        tree.query(region, [&](int userData) { overlapping.add(objects, userData); });
+        CHECK(coversBruteForce(objects, overlapping, [&](const AABB& box) { return box.overlaps(region); }));
+
+        glm::vec3 eye = randomPoint(random);
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 40.0f);
+        Frustum frustum(projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+        Reported visible(objects.size());
+        tree.queryFrustum(frustum, [&](int userData) { visible.add(objects, userData); });
+        CHECK(coversBruteForce(objects, visible, [&](const AABB& box) { return frustum.intersects(box); }));
+
+        Ray ray{ eye, glm::normalize(-eye + glm::vec3(0.01f, 0.02f, 0.03f)) };
+        const float maxDistance = 3.0f * WORLD;
+        Reported entered(objects.size());
+        tree.raycast(ray, maxDistance, [&](int userData, float) {
+            entered.add(objects, userData);
+            return maxDistance;
+        });
+        float distance;
+        CHECK(coversBruteForce(objects, entered, [&](const AABB& box) { return ray.intersects(box, maxDistance, distance); }));
+
+        // Pruning with the closest confirmed hit still finds the closest object.
+        float closest = maxDistance;
+        for (const Object& object : objects) {
+            if (object.proxy >= 0 && ray.intersects(object.box, closest, distance)) {
+                closest = distance;
+            }
+        }
+        float treeClosest = maxDistance;
+        tree.raycast(ray, maxDistance, [&](int userData, float) {
+            if (ray.intersects(objects[userData].box, treeClosest, distance)) {
+                treeClosest = distance;
+            }
+            return treeClosest;
+        });
+        CHECK_EQUAL(closest, treeClosest);
+    }
+}
+
+TEST(BVH_RandomOperationsKeepTreeValid) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> operation(0, 9);
+    std::uniform_real_distribution<float> nudge(-0.05f, 0.05f);
+    std::vector<Object> objects(400);
+    BVH tree;
+
+    bool valid = true;
+    for (int step = 0; step < 4000 && valid; step++) {
+        Object& object = objects[random() % objects.size()];
+        int op = operation(random);
+        if (object.proxy < 0) {
+            object.box = randomBox(random, randomPoint(random));
+            object.proxy = tree.createProxy(object.box, static_cast<int>(&object - objects.data()));
+        }
+        else if (op < 2) {
+            tree.destroyProxy(object.proxy);
+            object.proxy = -1;
+        }
+        else if (op < 5) {
+            // Small moves stay inside the fat bounds.
+            glm::vec3 offset(nudge(random), nudge(random), nudge(random));
+            object.box = AABB(object.box.min + offset, object.box.max + offset);
+            tree.moveProxy(object.proxy, object.box);
+        }
+        else {
+            object.box = randomBox(random, randomPoint(random));
+            CHECK(tree.moveProxy(object.proxy, object.box));
+        }
+
+        valid = tree.validate();
+        if (step % 100 == 0) {
+            checkQueries(random, tree, objects);
+        }
+    }
+    CHECK(valid);
+
+    int live = static_cast<int>(std::count_if(objects.begin(), objects.end(), [](const Object& o) { return o.proxy >= 0; }));
+    CHECK_EQUAL(live, tree.getProxyCount());
+    // Rotations keep the tree shallow: a balanced tree of 400 leaves is 9 levels high.
+    CHECK(tree.getHeight() <= 2 * 9);
+    checkQueries(random, tree, objects);
+
+    for (Object& object : objects) {
+        if (object.proxy >= 0) {
+            tree.destroyProxy(object.proxy);
+            object.proxy = -1;
+            REQUIRE(tree.validate());
+        }
+    }
+    CHECK_EQUAL(0, tree.getProxyCount());
+    CHECK_EQUAL(0, tree.getHeight());
+}
+
+TEST(BVH_MoveInsideFatBoundsLeavesTreeAlone) {
+    BVH tree(0.5f);
+    AABB box(glm::vec3(0.0f), glm::vec3(1.0f));
+    int proxy = tree.createProxy(box, 7);
+    CHECK_EQUAL(7, tree.getUserData(proxy));
+    CHECK(tree.getFatBounds(proxy).contains(box));
+
+    AABB nudged(glm::vec3(0.2f), glm::vec3(1.2f));
+    CHECK(!tree.moveProxy(proxy, nudged));
+    AABB moved(glm::vec3(5.0f), glm::vec3(6.0f));
+    CHECK(tree.moveProxy(proxy, moved));
+    CHECK(tree.getFatBounds(proxy).contains(moved));
+    CHECK(tree.validate());
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "Test.h"
+#include "FrameArena.h"
+
+TEST(FrameArray_GrowsPastItsBound) {
+    FrameArena arena(1024);
+    FrameArray<int> items(arena, 4);
+    for (int i = 0; i < 100; i++) {
+        items.push_back(i);
+    }
+    REQUIRE(items.size() == 100);
+    for (int i = 0; i < 100; i++) {
+        CHECK_EQUAL(i, items[i]);
+    }
+}
+
+TEST(FrameArray_WithoutArenaThrowsWhenFull) {
+    FrameArray<int> items;
+    CHECK(items.empty());
+    CHECK_THROWS(items.push_back(1));
+}
+
+TEST(FrameArena_OverflowGrowsBlockOnReset) {
+    FrameArena arena(256);
+    arena.allocate<char>(200);
+    char* spilled = arena.allocate<char>(200);
+    REQUIRE(spilled != nullptr);
+    CHECK_EQUAL(0u, arena.getGrowths());
+
+    arena.reset();
+    CHECK_EQUAL(1u, arena.getGrowths());
+    CHECK(arena.getCapacity() >= 400);
+
+    // The same frame now fits in the block.
+    arena.allocate<char>(200);
+    arena.allocate<char>(200);
+    arena.reset();
+    CHECK_EQUAL(1u, arena.getGrowths());
+}
\ No newline at end of file
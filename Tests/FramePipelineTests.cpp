@@ -0,0 +1,140 @@
+#include "Test.h"
+#include "FramePipeline.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST(FramePipeline_HandsListsOverInOrder) {
+    FramePipeline pipeline;
+
+    RenderCommandList* first = pipeline.beginRecording();
+    REQUIRE(first != nullptr);
+    CHECK_EQUAL(0u, first->getFrameIndex());
+    first->setInt(0, 100);
+    pipeline.submit(first);
+
+    // The second slot can be recorded while the first one waits for execution.
+    RenderCommandList* second = pipeline.beginRecording();
+    REQUIRE(second != nullptr);
+    CHECK(second != first);
+    CHECK_EQUAL(1u, second->getFrameIndex());
+    pipeline.submit(second);
+
+    RenderCommandList* executing = pipeline.beginExecution();
+    CHECK(executing == first);
+    CHECK_EQUAL(100, executing->getCommands()[0].count);
+    pipeline.endExecution(executing);
+
+    // The freed slot is reset for frame 2.
+    RenderCommandList* third = pipeline.beginRecording();
+    CHECK(third == first);
+    CHECK_EQUAL(2u, third->getFrameIndex());
+    CHECK(third->empty());
+    pipeline.submit(third);
+
+    CHECK(pipeline.beginExecution() == second);
+    pipeline.endExecution(second);
+    CHECK(pipeline.beginExecution() == third);
+    pipeline.endExecution(third);
+    pipeline.waitIdle();
+}
+
+TEST(FramePipeline_RecorderStaysAtMostOneFrameAhead) {
+    FramePipeline pipeline;
+    pipeline.submit(pipeline.beginRecording());
+    pipeline.submit(pipeline.beginRecording());
+
+    // Both slots are taken: the next recording has to wait for an execution.
+    std::atomic<bool> recorded{ false };
+    std::thread recorder([&] {
+        RenderCommandList* list = pipeline.beginRecording();
+        recorded = true;
+        pipeline.submit(list);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(!recorded);
+
+    RenderCommandList* list = pipeline.beginExecution();
+    pipeline.endExecution(list);
+    recorder.join();
+    CHECK(recorded);
+
+    for (int i = 0; i < 2; i++) {
+        list = pipeline.beginExecution();
+        pipeline.endExecution(list);
+    }
+    pipeline.waitIdle();
+}
+
+TEST(FramePipeline_StopReleasesBlockedThreads) {
+    FramePipeline pipeline;
+    std::atomic<bool> finished{ false };
+    std::thread executor([&] {
+        CHECK(pipeline.beginExecution() == nullptr);
+        finished = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!finished);
+    pipeline.stop();
+    executor.join();
+    CHECK(finished);
+    CHECK(pipeline.beginRecording() == nullptr);
+}
+
+TEST(FramePipeline_SubmittedFramesAreDrainedAfterStop) {
+    FramePipeline pipeline;
+    pipeline.submit(pipeline.beginRecording());
+    pipeline.stop();
+
+    RenderCommandList* list = pipeline.beginExecution();
+    REQUIRE(list != nullptr);
+    CHECK_EQUAL(0u, list->getFrameIndex());
+    pipeline.endExecution(list);
+    CHECK(pipeline.beginExecution() == nullptr);
+}
+
+// A recording thread and an executing thread, as in the application, without GL.
+TEST(FramePipeline_TwoThreadsSeeEveryFrameOnce) {
+    const int FRAME_COUNT = 2000;
+    FramePipeline pipeline;
+    std::atomic<int> executed{ 0 };
+    std::atomic<int> errors{ 0 };
+
+    std::thread executor([&] {
+        int expected = 0;
+        while (RenderCommandList* list = pipeline.beginExecution()) {
+            const auto& commands = list->getCommands();
+            if (list->getFrameIndex() != static_cast<uint64_t>(expected) || commands.size() != 2 ||
+                commands[0].count != expected) {
+                errors++;
+            }
+            else {
+                list->getTask(commands[1].dataIndex)();
+            }
+            expected++;
+            executed++;
+            pipeline.endExecution(list);
+        }
+    });
+
+    std::atomic<int> tasksRun{ 0 };
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        RenderCommandList* list = pipeline.beginRecording();
+        CHECK(list != nullptr);
+        if (!list) break;
+        // The slot for this frame was last used two frames ago, which must be done.
+        if (executed.load() < frame - 1) {
+            errors++;
+        }
+        list->setInt(0, frame);
+        list->runTask([&tasksRun] { tasksRun++; });
+        pipeline.submit(list);
+    }
+    pipeline.waitIdle();
+    pipeline.stop();
+    executor.join();
+
+    CHECK_EQUAL(0, errors.load());
+    CHECK_EQUAL(FRAME_COUNT, executed.load());
+    CHECK_EQUAL(FRAME_COUNT, tasksRun.load());
+}
\ No newline at end of file
@@ -0,0 +1,329 @@
+// Stand-ins for the OpenGL and GLFW entry points the renderer uses, so the scene
+// can run update/record/execute without a window or a GPU. Object names are handed
+// out in order, every compile, link and framebuffer succeeds, and the uniforms of a
+// program are read back from the GLSL source the way a driver would report them.
+#ifdef _WIN32
+#define WINGDIAPI
+#endif
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct Uniform {
+        std::string name;
+        GLint size;
+    };
+
+    struct Program {
+        std::vector<GLuint> shaders;
+        std::vector<Uniform> uniforms;
+        std::unordered_map<std::string, GLint> locations;
+        GLint maxNameLength = 0;
+    };
+
+    GLuint nextName = 1;
+    std::unordered_map<GLuint, std::string> shaderSources;
+    std::unordered_map<GLuint, Program> programs;
+
+    void generate(GLsizei n, GLuint* names) {
+        for (GLsizei i = 0; i < n; i++) {
+            names[i] = nextName++;
+        }
+    }
+
+    std::string stripComments(const std::string& source) {
+        std::string result;
+        for (size_t i = 0; i < source.size(); i++) {
+            if (source.compare(i, 2, "//") == 0) {
+                i = source.find('\n', i);
+                if (i == std::string::npos) break;
+            }
+            else if (source.compare(i, 2, "/*") == 0) {
+                i = source.find("*/", i);
+                if (i == std::string::npos) break;
+                i++;
+                continue;
+            }
+            result += source[i];
+        }
+        return result;
+    }
+
+    // Splits on white space with ; { } [ ] as tokens of their own.
+    std::vector<std::string> tokenize(const std::string& source) {
+        std::string spaced;
+        for (char c : stripComments(source)) {
+            if (c == ';' || c == '{' || c == '}' || c == '[' || c == ']') {
+                spaced += ' ';
+                spaced += c;
+                spaced += ' ';
+            }
+            else {
+                spaced += c;
+            }
+        }
+        std::istringstream stream(spaced);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (stream >> token) {
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    // Reads "type name;" or "type name[N];" starting at i.
+    bool readDeclaration(const std::vector<std::string>& tokens, size_t& i, std::string& type, Uniform& uniform) {
+        if (i + 2 >= tokens.size()) return false;
+        type = tokens[i++];
+        uniform.name = tokens[i++];
+        uniform.size = 1;
+        if (tokens[i] == "[" && i + 2 < tokens.size()) {
+            uniform.size = std::stoi(tokens[i + 1]);
+            i += 3;
+        }
+        return true;
+    }
+
+    // Active uniforms as glGetActiveUniform reports them: struct members one by one,
+    // arrays by their first element.
+    void addUniform(Program& program, const std::unordered_map<std::string, std::vector<Uniform>>& structs,
+        const std::string& type, const Uniform& uniform) {
+        auto it = structs.find(type);
+        if (it != structs.end()) {
+            for (GLint element = 0; element < uniform.size; element++) {
+                std::string prefix = uniform.size > 1 ? uniform.name + "[" + std::to_string(element) + "]" : uniform.name;
+                for (const Uniform& member : it->second) {
+                    addUniform(program, structs, "", Uniform{ prefix + "." + member.name, member.size });
+                }
+            }
+            return;
+        }
+
+        for (const Uniform& existing : program.uniforms) {
+            if (existing.name == uniform.name || existing.name == uniform.name + "[0]") return;
+        }
+        GLint location = static_cast<GLint>(program.locations.size());
+        if (uniform.size > 1) {
+            program.uniforms.push_back(Uniform{ uniform.name + "[0]", uniform.size });
+            program.locations[uniform.name] = location;
+            for (GLint element = 0; element < uniform.size; element++) {
+                program.locations[uniform.name + "[" + std::to_string(element) + "]"] = location + element;
+            }
+        }
+        else {
+            program.uniforms.push_back(uniform);
+            program.locations[uniform.name] = location;
+        }
+        GLint length = static_cast<GLint>(program.uniforms.back().name.size()) + 1;
+        if (length > program.maxNameLength) program.maxNameLength = length;
+    }
+
+    void readUniforms(Program& program, const std::string& source) {
+        std::vector<std::string> tokens = tokenize(source);
+        std::unordered_map<std::string, std::vector<Uniform>> structs;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            if (tokens[i] == "struct" && i + 2 < tokens.size() && tokens[i + 2] == "{") {
+                std::vector<Uniform>& members = structs[tokens[i + 1]];
+                i += 3;
+                std::string type;
+                Uniform member;
+                while (i < tokens.size() && tokens[i] != "}" && readDeclaration(tokens, i, type, member)) {
+                    members.push_back(member);
+                    if (i < tokens.size() && tokens[i] == ";") i++;
+                }
+            }
+            else if (tokens[i] == "uniform") {
+                size_t next = i + 1;
+                std::string type;
+                Uniform uniform;
+                if (readDeclaration(tokens, next, type, uniform)) {
+                    addUniform(program, structs, type, uniform);
+                }
+            }
+        }
+    }
+
+    void copyString(const std::string& value, GLsizei bufSize, GLsizei* length, GLchar* buffer) {
+        GLsizei count = bufSize > 0 ? static_cast<GLsizei>(std::min(value.size(), static_cast<size_t>(bufSize - 1))) : 0;
+        if (buffer && bufSize > 0) {
+            std::memcpy(buffer, value.data(), count);
+            buffer[count] = '\0';
+        }
+        if (length) *length = count;
+    }
+
+    void GLAPIENTRY stubActiveTexture(GLenum) {}
+    void GLAPIENTRY stubAttachShader(GLuint program, GLuint shader) { programs[program].shaders.push_back(shader); }
+    void GLAPIENTRY stubBeginQuery(GLenum, GLuint) {}
+    void GLAPIENTRY stubBindBuffer(GLenum, GLuint) {}
+    void GLAPIENTRY stubBindFramebuffer(GLenum, GLuint) {}
+    void GLAPIENTRY stubBindRenderbuffer(GLenum, GLuint) {}
+    void GLAPIENTRY stubBindVertexArray(GLuint) {}
+    void GLAPIENTRY stubBlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) {}
+    void GLAPIENTRY stubBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+    GLenum GLAPIENTRY stubCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+    void GLAPIENTRY stubCompileShader(GLuint) {}
+    GLuint GLAPIENTRY stubCreateProgram() { GLuint name = nextName++; programs[name]; return name; }
+    GLuint GLAPIENTRY stubCreateShader(GLenum) { GLuint name = nextName++; shaderSources[name]; return name; }
+    void GLAPIENTRY stubDeleteNames(GLsizei, const GLuint*) {}
+    void GLAPIENTRY stubDeleteProgram(GLuint program) { programs.erase(program); }
+    void GLAPIENTRY stubDeleteShader(GLuint shader) { shaderSources.erase(shader); }
+    void GLAPIENTRY stubDetachShader(GLuint, GLuint) {}
+    void GLAPIENTRY stubEnableVertexAttribArray(GLuint) {}
+    void GLAPIENTRY stubEndQuery(GLenum) {}
+    void GLAPIENTRY stubFramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) {}
+    void GLAPIENTRY stubFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+    void GLAPIENTRY stubGenNames(GLsizei n, GLuint* names) { generate(n, names); }
+    void GLAPIENTRY stubGenerateMipmap(GLenum) {}
+    void GLAPIENTRY stubGetActiveUniform(GLuint program, GLuint index, GLsizei maxLength, GLsizei* length, GLint* size,
+        GLenum* type, GLchar* name) {
+        const Uniform& uniform = programs[program].uniforms.at(index);
+        copyString(uniform.name, maxLength, length, name);
+        if (size) *size = uniform.size;
+        if (type) *type = GL_FLOAT;
+    }
+    void GLAPIENTRY stubGetProgramBinary(GLuint, GLsizei, GLsizei* length, GLenum*, void*) { if (length) *length = 0; }
+    void GLAPIENTRY stubGetInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+        copyString("", bufSize, length, infoLog);
+    }
+    void GLAPIENTRY stubGetProgramiv(GLuint program, GLenum pname, GLint* param) {
+        switch (pname) {
+        case GL_LINK_STATUS: *param = GL_TRUE; break;
+        case GL_ACTIVE_UNIFORMS: *param = static_cast<GLint>(programs[program].uniforms.size()); break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH: *param = programs[program].maxNameLength; break;
+        case GL_COMPLETION_STATUS_ARB: *param = GL_TRUE; break;
+        default: *param = 0; break;
+        }
+    }
+    void GLAPIENTRY stubGetQueryObjectiv(GLuint, GLenum pname, GLint* params) {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+    // A steady 5 ms, well inside the dynamic resolution target.
+    void GLAPIENTRY stubGetQueryObjectui64v(GLuint, GLenum, GLuint64* params) { *params = 5000000; }
+    void GLAPIENTRY stubGetShaderiv(GLuint, GLenum pname, GLint* param) {
+        *param = pname == GL_COMPILE_STATUS || pname == GL_COMPLETION_STATUS_ARB ? GL_TRUE : 0;
+    }
+    GLint GLAPIENTRY stubGetUniformLocation(GLuint program, const GLchar* name) {
+        const Program& target = programs[program];
+        auto it = target.locations.find(name);
+        return it == target.locations.end() ? -1 : it->second;
+    }
+    void GLAPIENTRY stubLinkProgram(GLuint program) {
+        Program& target = programs[program];
+        target.uniforms.clear();
+        target.locations.clear();
+        target.maxNameLength = 0;
+        for (GLuint shader : target.shaders) {
+            readUniforms(target, shaderSources[shader]);
+        }
+    }
+    void GLAPIENTRY stubProgramBinary(GLuint, GLenum, const void*, GLsizei) {}
+    void GLAPIENTRY stubProgramParameteri(GLuint, GLenum, GLint) {}
+    void GLAPIENTRY stubRenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) {}
+    void GLAPIENTRY stubShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+        std::string& source = shaderSources[shader];
+        source.clear();
+        for (GLsizei i = 0; i < count; i++) {
+            if (length && length[i] >= 0) source.append(string[i], length[i]);
+            else source += string[i];
+        }
+    }
+    void GLAPIENTRY stubUniform1f(GLint, GLfloat) {}
+    void GLAPIENTRY stubUniform1i(GLint, GLint) {}
+    void GLAPIENTRY stubUniform3fv(GLint, GLsizei, const GLfloat*) {}
+    void GLAPIENTRY stubUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+    void GLAPIENTRY stubUseProgram(GLuint) {}
+    void GLAPIENTRY stubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+}
+
+// No extensions: the program binary cache and parallel compilation stay off.
+GLboolean __GLEW_VERSION_4_1 = GL_FALSE;
+GLboolean __GLEW_ARB_get_program_binary = GL_FALSE;
+GLboolean __GLEW_ARB_parallel_shader_compile = GL_FALSE;
+GLboolean __GLEW_KHR_parallel_shader_compile = GL_FALSE;
+
+PFNGLACTIVETEXTUREPROC __glewActiveTexture = stubActiveTexture;
+PFNGLATTACHSHADERPROC __glewAttachShader = stubAttachShader;
+PFNGLBEGINQUERYPROC __glewBeginQuery = stubBeginQuery;
+PFNGLBINDBUFFERPROC __glewBindBuffer = stubBindBuffer;
+PFNGLBINDFRAMEBUFFERPROC __glewBindFramebuffer = stubBindFramebuffer;
+PFNGLBINDRENDERBUFFERPROC __glewBindRenderbuffer = stubBindRenderbuffer;
+PFNGLBINDVERTEXARRAYPROC __glewBindVertexArray = stubBindVertexArray;
+PFNGLBLITFRAMEBUFFERPROC __glewBlitFramebuffer = stubBlitFramebuffer;
+PFNGLBUFFERDATAPROC __glewBufferData = stubBufferData;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC __glewCheckFramebufferStatus = stubCheckFramebufferStatus;
+PFNGLCOMPILESHADERPROC __glewCompileShader = stubCompileShader;
+PFNGLCREATEPROGRAMPROC __glewCreateProgram = stubCreateProgram;
+PFNGLCREATESHADERPROC __glewCreateShader = stubCreateShader;
+PFNGLDELETEBUFFERSPROC __glewDeleteBuffers = stubDeleteNames;
+PFNGLDELETEFRAMEBUFFERSPROC __glewDeleteFramebuffers = stubDeleteNames;
+PFNGLDELETEPROGRAMPROC __glewDeleteProgram = stubDeleteProgram;
+PFNGLDELETEQUERIESPROC __glewDeleteQueries = stubDeleteNames;
+PFNGLDELETERENDERBUFFERSPROC __glewDeleteRenderbuffers = stubDeleteNames;
+PFNGLDELETESHADERPROC __glewDeleteShader = stubDeleteShader;
+PFNGLDELETEVERTEXARRAYSPROC __glewDeleteVertexArrays = stubDeleteNames;
+PFNGLDETACHSHADERPROC __glewDetachShader = stubDetachShader;
+PFNGLENABLEVERTEXATTRIBARRAYPROC __glewEnableVertexAttribArray = stubEnableVertexAttribArray;
+PFNGLENDQUERYPROC __glewEndQuery = stubEndQuery;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC __glewFramebufferRenderbuffer = stubFramebufferRenderbuffer;
+PFNGLFRAMEBUFFERTEXTURE2DPROC __glewFramebufferTexture2D = stubFramebufferTexture2D;
+PFNGLGENBUFFERSPROC __glewGenBuffers = stubGenNames;
+PFNGLGENFRAMEBUFFERSPROC __glewGenFramebuffers = stubGenNames;
+PFNGLGENQUERIESPROC __glewGenQueries = stubGenNames;
+PFNGLGENRENDERBUFFERSPROC __glewGenRenderbuffers = stubGenNames;
+PFNGLGENVERTEXARRAYSPROC __glewGenVertexArrays = stubGenNames;
+PFNGLGENERATEMIPMAPPROC __glewGenerateMipmap = stubGenerateMipmap;
+PFNGLGETACTIVEUNIFORMPROC __glewGetActiveUniform = stubGetActiveUniform;
+PFNGLGETPROGRAMBINARYPROC __glewGetProgramBinary = stubGetProgramBinary;
+PFNGLGETPROGRAMINFOLOGPROC __glewGetProgramInfoLog = stubGetInfoLog;
+PFNGLGETPROGRAMIVPROC __glewGetProgramiv = stubGetProgramiv;
+PFNGLGETQUERYOBJECTIVPROC __glewGetQueryObjectiv = stubGetQueryObjectiv;
+PFNGLGETQUERYOBJECTUI64VPROC __glewGetQueryObjectui64v = stubGetQueryObjectui64v;
+PFNGLGETSHADERINFOLOGPROC __glewGetShaderInfoLog = stubGetInfoLog;
+PFNGLGETSHADERIVPROC __glewGetShaderiv = stubGetShaderiv;
+PFNGLGETUNIFORMLOCATIONPROC __glewGetUniformLocation = stubGetUniformLocation;
+PFNGLLINKPROGRAMPROC __glewLinkProgram = stubLinkProgram;
+PFNGLPROGRAMBINARYPROC __glewProgramBinary = stubProgramBinary;
+PFNGLPROGRAMPARAMETERIPROC __glewProgramParameteri = stubProgramParameteri;
+PFNGLRENDERBUFFERSTORAGEPROC __glewRenderbufferStorage = stubRenderbufferStorage;
+PFNGLSHADERSOURCEPROC __glewShaderSource = stubShaderSource;
+PFNGLUNIFORM1FPROC __glewUniform1f = stubUniform1f;
+PFNGLUNIFORM1IPROC __glewUniform1i = stubUniform1i;
+PFNGLUNIFORM3FVPROC __glewUniform3fv = stubUniform3fv;
+PFNGLUNIFORMMATRIX4FVPROC __glewUniformMatrix4fv = stubUniformMatrix4fv;
+PFNGLUSEPROGRAMPROC __glewUseProgram = stubUseProgram;
+PFNGLVERTEXATTRIBPOINTERPROC __glewVertexAttribPointer = stubVertexAttribPointer;
+
+void GLAPIENTRY glBindTexture(GLenum, GLuint) {}
+void GLAPIENTRY glClear(GLbitfield) {}
+void GLAPIENTRY glDeleteTextures(GLsizei, const GLuint*) {}
+void GLAPIENTRY glDrawBuffer(GLenum) {}
+void GLAPIENTRY glDrawElements(GLenum, GLsizei, GLenum, const void*) {}
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint* textures) { generate(n, textures); }
+void GLAPIENTRY glGetFloatv(GLenum pname, GLfloat* params) {
+    *params = pname == GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT ? 16.0f : 0.0f;
+}
+void GLAPIENTRY glGetIntegerv(GLenum, GLint* params) { *params = 0; }
+const GLubyte* GLAPIENTRY glGetString(GLenum) { return reinterpret_cast<const GLubyte*>("Stub"); }
+void GLAPIENTRY glPixelStorei(GLenum, GLint) {}
+void GLAPIENTRY glReadBuffer(GLenum) {}
+void GLAPIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) {}
+void GLAPIENTRY glTexParameterf(GLenum, GLenum, GLfloat) {}
+void GLAPIENTRY glTexParameterfv(GLenum, GLenum, const GLfloat*) {}
+void GLAPIENTRY glTexParameteri(GLenum, GLenum, GLint) {}
+void GLAPIENTRY glViewport(GLint, GLint, GLsizei, GLsizei) {}
+
+int glfwGetKey(GLFWwindow*, int) { return GLFW_RELEASE; }
+GLFWmonitor* glfwGetPrimaryMonitor() {
+    static char monitor;
+    return reinterpret_cast<GLFWmonitor*>(&monitor);
+}
+const GLFWvidmode* glfwGetVideoMode(GLFWmonitor*) {
+    static const GLFWvidmode mode = { 1280, 720, 8, 8, 8, 60 };
+    return &mode;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "Test.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(JobSystem_WaitRunsEveryJob) {
+    JobSystem jobs(3);
+    JobCounter counter;
+    std::atomic<int> runs{ 0 };
+    for (int i = 0; i < 1000; i++) {
+        jobs.run([&runs] { runs++; }, &counter);
+    }
+    jobs.wait(counter);
+    CHECK(counter.isDone());
+    CHECK_EQUAL(1000, runs.load());
+}
+
+TEST(JobSystem_ParallelForCoversEveryIndexOnce) {
+    JobSystem jobs(3);
+    std::vector<std::atomic<int>> hits(10007);
+    jobs.parallelFor(hits.size(), 64, [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) hits[i]++;
+    });
+    int wrong = 0;
+    for (const auto& hit : hits) {
+        if (hit.load() != 1) wrong++;
+    }
+    CHECK_EQUAL(0, wrong);
+}
+
+TEST(JobSystem_RunAfterStartsOnceDependencyIsDone) {
+    JobSystem jobs(2);
+    JobCounter first;
+    JobCounter second;
+    std::atomic<int> finished{ 0 };
+    std::atomic<int> seenByContinuation{ -1 };
+    for (int i = 0; i < 50; i++) {
+        jobs.run([&finished] { finished++; }, &first);
+    }
+    jobs.runAfter(first, [&] { seenByContinuation = finished.load(); }, &second);
+    jobs.wait(second);
+    CHECK_EQUAL(50, seenByContinuation.load());
+}
+
+TEST(JobSystem_WaitRethrowsJobException) {
+    JobSystem jobs(2);
+    JobCounter counter;
+    std::atomic<int> runs{ 0 };
+    for (int i = 0; i < 100; i++) {
+        jobs.run([&runs, i] {
+            runs++;
+            if (i == 37) throw std::runtime_error("job 37");
+        }, &counter);
+    }
+
+    std::string message;
+    try {
+        jobs.wait(counter);
+    }
+    catch (const std::runtime_error& e) {
+        message = e.what();
+    }
+    CHECK_EQUAL(std::string("job 37"), message);
+    CHECK(counter.isDone());
+    CHECK_EQUAL(100, runs.load());
+
+    // The exception is reported once, and the workers are still alive afterwards.
+    jobs.wait(counter);
+    jobs.run([&runs] { runs++; }, &counter);
+    jobs.wait(counter);
+    CHECK_EQUAL(101, runs.load());
+}
+
+TEST(JobSystem_ThrowingDependencyStillReleasesContinuation) {
+    JobSystem jobs(2);
+    JobCounter first;
+    JobCounter second;
+    std::atomic<bool> continued{ false };
+    jobs.run([] { throw std::runtime_error("dependency"); }, &first);
+    jobs.runAfter(first, [&continued] { continued = true; }, &second);
+    jobs.wait(second);
+    CHECK(continued);
+    CHECK_THROWS(jobs.wait(first));
+}
+
+TEST(JobSystem_ParallelForRethrowsAfterAllRangesFinish) {
+    JobSystem jobs(3);
+    std::atomic<int> ranges{ 0 };
+    bool threw = false;
+    try {
+        jobs.parallelFor(64, 1, [&ranges](size_t begin, size_t) {
+            ranges++;
+            if (begin % 8 == 0) throw std::runtime_error("range");
+        });
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK_EQUAL(64, ranges.load());
+}
+
+TEST(JobSystem_JobWithoutCounterMayThrow) {
+    JobSystem jobs(1);
+    jobs.run([] { throw std::runtime_error("nobody is waiting"); });
+    JobCounter counter;
+    std::atomic<bool> ran{ false };
+    jobs.run([&ran] { ran = true; }, &counter);
+    jobs.wait(counter);
+    CHECK(ran);
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "Test.h"
+#include "MipStreamingPolicy.h"
+
+namespace {
+    const int SIZE = 1024;          // 11 levels
+    const int COARSEST = 4;         // 64x64, what models upload
+
+    MipStreamingPolicy::TextureState makeTexture(int residentLevel) {
+        MipStreamingPolicy::TextureState texture;
+        texture.width = SIZE;
+        texture.height = SIZE;
+        texture.bytesPerTexel = 4;
+        texture.residentLevel = residentLevel;
+        texture.coarsestLevel = COARSEST;
+        return texture;
+    }
+
+    bool hasChange(const std::vector<MipStreamingPolicy::Change>& changes, size_t index, size_t texture, int level, bool load) {
+        return index < changes.size() && changes[index].texture == texture && changes[index].level == level &&
+            changes[index].load == load;
+    }
+}
+
+TEST(MipStreamingPolicy_RequiredLevelFollowsProjectedSize) {
+    MipStreamingPolicy policy;
+    MipStreamingPolicy::TextureState texture = makeTexture(COARSEST);
+    CHECK_EQUAL(0, policy.requiredLevel(texture, 1024.0f));
+    CHECK_EQUAL(0, policy.requiredLevel(texture, 4096.0f));
+    CHECK_EQUAL(2, policy.requiredLevel(texture, 256.0f));
+    CHECK_EQUAL(1, policy.requiredLevel(texture, 300.0f));
+    CHECK_EQUAL(10, policy.requiredLevel(texture, 0.0f));
+
+    MipStreamingSettings biased;
+    biased.lodBias = 1.0f;
+    CHECK_EQUAL(3, MipStreamingPolicy(biased).requiredLevel(texture, 256.0f));
+}
+
+TEST(MipStreamingPolicy_FeedbackKeepsFinestLevelOfTheFrame) {
+    MipStreamingPolicy policy;
+    MipStreamingPolicy::TextureState texture = makeTexture(COARSEST);
+    policy.addFeedback(texture, 128.0f, 1);
+    policy.addFeedback(texture, 512.0f, 1);
+    policy.addFeedback(texture, 64.0f, 1);
+    CHECK_EQUAL(1, texture.wantedLevel);
+    CHECK_EQUAL(512.0f, texture.priority);
+
+    // A new frame starts over.
+    policy.addFeedback(texture, 64.0f, 2);
+    CHECK_EQUAL(4, texture.wantedLevel);
+    CHECK_EQUAL(64.0f, texture.priority);
+}
+
+TEST(MipStreamingPolicy_LoadsMostVisibleFirst) {
+    MipStreamingPolicy policy;
+    std::vector<MipStreamingPolicy::TextureState> textures(3, makeTexture(COARSEST));
+    policy.addFeedback(textures[0], 1024.0f, 1);
+    policy.addFeedback(textures[1], 4096.0f, 1);
+    policy.addFeedback(textures[2], 2048.0f, 1);
+
+    std::vector<MipStreamingPolicy::Change> changes;
+    policy.plan(textures, 1, changes);
+    REQUIRE(changes.size() == 2);
+    CHECK(hasChange(changes, 0, 1, 0, true));
+    CHECK(hasChange(changes, 1, 2, 0, true));
+    CHECK(textures[1].loading);
+    CHECK(textures[2].loading);
+    CHECK(!textures[0].loading);
+
+    // maxLoadsInFlight is reached until one of them finishes.
+    policy.plan(textures, 1, changes);
+    CHECK(changes.empty());
+    MipStreamingPolicy::finishLoad(textures[1], 0);
+    CHECK_EQUAL(0, textures[1].residentLevel);
+    policy.plan(textures, 1, changes);
+    REQUIRE(changes.size() == 1);
+    CHECK(hasChange(changes, 0, 0, 0, true));
+}
+
+TEST(MipStreamingPolicy_OverBudgetCoarsensLeastVisibleFirst) {
+    MipStreamingPolicy::TextureState reference = makeTexture(0);
+    size_t fullChain = MipStreamingPolicy::chainBytes(reference, 0);
+    size_t level0 = MipStreamingPolicy::levelBytes(reference, 0);
+
+    // One level of one texture too much: only the least visible one drops it.
+    {
+        MipStreamingSettings settings;
+        settings.budget = 3 * fullChain - 1;
+        MipStreamingPolicy policy(settings);
+        std::vector<MipStreamingPolicy::TextureState> textures(3, makeTexture(0));
+        policy.addFeedback(textures[0], 1024.0f, 1);
+        policy.addFeedback(textures[1], 3072.0f, 1);
+        policy.addFeedback(textures[2], 2048.0f, 1);
+
+        std::vector<MipStreamingPolicy::Change> changes;
+        policy.plan(textures, 1, changes);
+        REQUIRE(changes.size() == 1);
+        CHECK(hasChange(changes, 0, 0, 1, false));
+        CHECK_EQUAL(1, textures[0].residentLevel);
+        CHECK(MipStreamingPolicy::residentBytes(textures) <= settings.budget);
+    }
+
+    // The least visible texture goes all the way to its coarsest level before the
+    // next one loses anything; the most visible one keeps everything.
+    {
+        MipStreamingSettings settings;
+        settings.budget = 3 * fullChain - (fullChain - MipStreamingPolicy::chainBytes(reference, COARSEST)) - level0;
+        MipStreamingPolicy policy(settings);
+        std::vector<MipStreamingPolicy::TextureState> textures(3, makeTexture(0));
+        policy.addFeedback(textures[0], 1024.0f, 1);
+        policy.addFeedback(textures[1], 3072.0f, 1);
+        policy.addFeedback(textures[2], 2048.0f, 1);
+
+        std::vector<MipStreamingPolicy::Change> changes;
+        policy.plan(textures, 1, changes);
+        REQUIRE(changes.size() == 2);
+        CHECK(hasChange(changes, 0, 0, COARSEST, false));
+        CHECK(hasChange(changes, 1, 2, 1, false));
+        CHECK_EQUAL(0, textures[1].residentLevel);
+        CHECK(MipStreamingPolicy::residentBytes(textures) <= settings.budget);
+    }
+}
+
+TEST(MipStreamingPolicy_NeverEvictsBelowCoarsestLevel) {
+    MipStreamingSettings settings;
+    settings.budget = 0;
+    MipStreamingPolicy policy(settings);
+    std::vector<MipStreamingPolicy::TextureState> textures(2, makeTexture(0));
+    policy.addFeedback(textures[0], 1024.0f, 1);
+    policy.addFeedback(textures[1], 2048.0f, 1);
+
+    std::vector<MipStreamingPolicy::Change> changes;
+    policy.plan(textures, 1, changes);
+    REQUIRE(changes.size() == 2);
+    CHECK(hasChange(changes, 0, 0, COARSEST, false));
+    CHECK(hasChange(changes, 1, 1, COARSEST, false));
+
+    policy.plan(textures, 2, changes);
+    CHECK(changes.empty());
+}
+
+TEST(MipStreamingPolicy_KeepsRecentLevelsForKeepFrames) {
+    MipStreamingSettings settings;
+    settings.keepFrames = 5;
+    MipStreamingPolicy policy(settings);
+    std::vector<MipStreamingPolicy::TextureState> textures(1, makeTexture(0));
+    std::vector<MipStreamingPolicy::Change> changes;
+
+    // Seen from far away: it would only need level 4, but recent levels are kept.
+    policy.addFeedback(textures[0], 64.0f, 1);
+    for (uint64_t frame = 1; frame <= 6; frame++) {
+        policy.plan(textures, frame, changes);
+        CHECK(changes.empty());
+    }
+    CHECK_EQUAL(0, textures[0].residentLevel);
+
+    policy.plan(textures, 7, changes);
+    REQUIRE(changes.size() == 1);
+    CHECK(hasChange(changes, 0, 0, COARSEST, false));
+}
+
+TEST(MipStreamingPolicy_DoesNotEvictWhileLoading) {
+    MipStreamingSettings settings;
+    settings.budget = 0;
+    MipStreamingPolicy policy(settings);
+    std::vector<MipStreamingPolicy::TextureState> textures(1, makeTexture(2));
+    textures[0].loading = true;
+
+    std::vector<MipStreamingPolicy::Change> changes;
+    policy.plan(textures, 1, changes);
+    CHECK(changes.empty());
+    CHECK_EQUAL(2, textures[0].residentLevel);
+}
\ No newline at end of file
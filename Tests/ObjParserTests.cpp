@@ -0,0 +1,180 @@
+#include "Test.h"
+#include "ObjParser.h"
+#include <cstdio>
+#include <fstream>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+namespace {
+    struct ShippedModel {
+        const char* obj;
+        const char* directory;
+    };
+
+    const ShippedModel SHIPPED_MODELS[] = {
+        { "../Models/muzeu.obj", "../Models/" },
+        { "../Models/Book_Shelf/bookshelf.obj", "../Models/Book_Shelf/" },
+        { "../Models/Camera/camera.obj", "../Models/Camera/" },
+        { "../Models/Canon/OldShipCannon.obj", "../Models/Canon/" },
+        { "../Models/Chest/chest.obj", "../Models/Chest/" },
+        { "../Models/Lantern/lantern.obj", "../Models/Lantern/" },
+        { "../Models/Medieval_Chest/medieval_chest.obj", "../Models/Medieval_Chest/" },
+        { "../Models/Medieval_Desk/medieval_desk.obj", "../Models/Medieval_Desk/" },
+        { "../Models/Old_Table/old_table.obj", "../Models/Old_Table/" },
+        { "../Models/Stand/stand.obj", "../Models/Stand/" },
+        { "../Models/Sword/sword.obj", "../Models/Sword/" },
+        { "../Models/Table/table.obj", "../Models/Table/" },
+    };
+
+    // What the tinyobjloader based loader produced: one vertex per face corner in the
+    // same interleaved layout, and the diffuse texture of every triangle.
+    struct Reference {
+        std::vector<float> vertices;
+        std::vector<std::string> triangleTextures;
+        size_t materialCount = 0;
+    };
+
+    Reference loadReference(const ShippedModel& model) {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, model.obj, model.directory)) {
+            throw std::runtime_error(warn + err);
+        }
+
+        Reference reference;
+        reference.materialCount = materials.size();
+        for (const auto& shape : shapes) {
+            for (const auto& index : shape.mesh.indices) {
+                const float* position = &attrib.vertices[3 * index.vertex_index];
+                reference.vertices.insert(reference.vertices.end(), position, position + 3);
+                if (index.normal_index >= 0) {
+                    const float* normal = &attrib.normals[3 * index.normal_index];
+                    reference.vertices.insert(reference.vertices.end(), normal, normal + 3);
+                }
+                else {
+                    reference.vertices.insert(reference.vertices.end(), { 0.0f, 1.0f, 0.0f });
+                }
+                if (index.texcoord_index >= 0) {
+                    const float* texcoord = &attrib.texcoords[2 * index.texcoord_index];
+                    reference.vertices.insert(reference.vertices.end(), texcoord, texcoord + 2);
+                }
+                else {
+                    reference.vertices.insert(reference.vertices.end(), { 0.0f, 0.0f });
+                }
+            }
+            for (int material : shape.mesh.material_ids) {
+                reference.triangleTextures.push_back(material >= 0 ? materials[material].diffuse_texname : std::string());
+            }
+        }
+        return reference;
+    }
+
+    size_t countMaterials(const ObjParser::Result& result) {
+        std::vector<std::string> names;
+        for (const auto& mesh : result.meshes) {
+            if (!mesh.material.empty() && std::find(names.begin(), names.end(), mesh.material) == names.end()) {
+                names.push_back(mesh.material);
+            }
+        }
+        return names.size();
+    }
+
+    void checkMatchesReference(const ShippedModel& model, const ObjParser::Result& result, const Reference& reference) {
+        std::vector<float> vertices;
+        std::vector<std::string> triangleTextures;
+        size_t indexCount = 0;
+        for (const auto& mesh : result.meshes) {
+            vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+            triangleTextures.insert(triangleTextures.end(), mesh.indices.size() / 3, mesh.diffuseTexture);
+            indexCount += mesh.indices.size();
+        }
+
+        CHECK_EQUAL(reference.vertices.size(), vertices.size());
+        CHECK_EQUAL(reference.vertices.size() / 8, indexCount);
+        CHECK_EQUAL(reference.triangleTextures.size(), triangleTextures.size());
+        CHECK(reference.triangleTextures == triangleTextures);
+        // Materials that no face uses are not kept, so only check the ones in use.
+        CHECK(countMaterials(result) <= reference.materialCount);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < std::min(vertices.size(), reference.vertices.size()); i++) {
+            float tolerance = 1e-5f * std::max(1.0f, std::fabs(reference.vertices[i]));
+            if (std::fabs(vertices[i] - reference.vertices[i]) > tolerance) mismatches++;
+        }
+        if (mismatches) {
+            Test::fail(model.obj, 0, std::to_string(mismatches) + " vertex components differ from tinyobjloader");
+        }
+    }
+}
+
+TEST(ObjParser_MatchesTinyObjLoaderOnShippedModels) {
+    for (const ShippedModel& model : SHIPPED_MODELS) {
+        checkMatchesReference(model, ObjParser::load(model.obj, model.directory), loadReference(model));
+    }
+}
+
+TEST(ObjParser_ParallelParseMatchesSerialParse) {
+    JobSystem jobs(3);
+    for (const ShippedModel& model : SHIPPED_MODELS) {
+        ObjParser::Result serial = ObjParser::load(model.obj, model.directory);
+        ObjParser::Result parallel = ObjParser::load(model.obj, model.directory, &jobs);
+        REQUIRE(serial.meshes.size() == parallel.meshes.size());
+        for (size_t m = 0; m < serial.meshes.size(); m++) {
+            CHECK(serial.meshes[m].vertices == parallel.meshes[m].vertices);
+            CHECK(serial.meshes[m].indices == parallel.meshes[m].indices);
+            CHECK_EQUAL(serial.meshes[m].diffuseTexture, parallel.meshes[m].diffuseTexture);
+        }
+        CHECK(serial.bounds.min == parallel.bounds.min);
+        CHECK(serial.bounds.max == parallel.bounds.max);
+    }
+}
+
+TEST(ObjParser_MissingMaterialLibraryFallsBackToDefaults) {
+    const char* path = "ObjParserTests_missing_mtl.obj";
+    {
+        std::ofstream file(path);
+        file << "mtllib does_not_exist.mtl\n"
+            "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+            "usemtl wood\n"
+            "f 1 2 3 4\n";
+    }
+
+    ObjParser::Result result;
+    bool threw = false;
+    try {
+        result = ObjParser::load(path, "./");
+    }
+    catch (const std::exception&) {
+        threw = true;
+    }
+    std::remove(path);
+
+    REQUIRE(!threw);
+    REQUIRE(result.meshes.size() == 1);
+    CHECK_EQUAL(std::string("wood"), result.meshes[0].material);
+    CHECK(result.meshes[0].diffuseTexture.empty());
+    CHECK_EQUAL(6u, result.meshes[0].indices.size());
+}
+
+// Indices too large for an int must not wrap around into a valid vertex.
+TEST(ObjParser_RejectsOverflowingIndices) {
+    const char* path = "ObjParserTests_overflow.obj";
+    const char* faces[] = {
+        "f 1 2 99999999999\n",
+        "f 1 2 4294967299\n",          // 3 after wrapping to 32 bits
+        "f 1 2 -4294967295\n",
+        "f 1/99999999999 2/1 3/1\n",
+        "f 1//4294967297 2//1 3//1\n",
+    };
+    for (const char* face : faces) {
+        {
+            std::ofstream file(path);
+            file << "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nvn 0 0 1\n" << face;
+        }
+        CHECK_THROWS(ObjParser::load(path, "./"));
+    }
+    std::remove(path);
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "Test.h"
+#include "RenderCommandList.h"
+
+namespace {
+    RenderCommandType typeAt(const RenderCommandList& list, size_t index) {
+        return list.getCommands()[index].type;
+    }
+}
+
+TEST(RenderCommandList_RecordsCommandsInOrder) {
+    RenderCommandList list;
+    list.reset(7);
+    list.setViewport(0, 0, 640, 480);
+    list.bindFramebuffer(3);
+    list.clear(0x4100);
+    list.useProgram(5);
+    list.setInt(2, 4);
+    list.setFloat(6, 0.5f);
+    list.bindTexture(1, 9);
+    list.drawIndexed(11, 36);
+    list.setPresent(true);
+
+    REQUIRE(list.getCommands().size() == 8);
+    CHECK(typeAt(list, 0) == RenderCommandType::SetViewport);
+    CHECK(typeAt(list, 1) == RenderCommandType::BindFramebuffer);
+    CHECK(typeAt(list, 2) == RenderCommandType::Clear);
+    CHECK(typeAt(list, 3) == RenderCommandType::UseProgram);
+    CHECK(typeAt(list, 4) == RenderCommandType::SetInt);
+    CHECK(typeAt(list, 5) == RenderCommandType::SetFloat);
+    CHECK(typeAt(list, 6) == RenderCommandType::BindTexture);
+    CHECK(typeAt(list, 7) == RenderCommandType::DrawIndexed);
+
+    const auto& commands = list.getCommands();
+    CHECK(list.getVector(commands[0].dataIndex) == glm::vec4(0, 0, 640, 480));
+    CHECK_EQUAL(3u, commands[1].handle);
+    CHECK_EQUAL(0x4100, commands[2].count);
+    CHECK_EQUAL(5u, commands[3].handle);
+    CHECK_EQUAL(2, commands[4].location);
+    CHECK_EQUAL(4, commands[4].count);
+    CHECK_EQUAL(0.5f, commands[5].value);
+    CHECK_EQUAL(1, commands[6].location);
+    CHECK_EQUAL(9u, commands[6].handle);
+    CHECK_EQUAL(11u, commands[7].handle);
+    CHECK_EQUAL(36, commands[7].count);
+    CHECK_EQUAL(7u, list.getFrameIndex());
+    CHECK(list.shouldPresent());
+}
+
+TEST(RenderCommandList_KeepsPayloadsInPools) {
+    RenderCommandList list;
+    glm::mat4 first(2.0f);
+    glm::mat4 second = glm::mat4(1.0f) * 3.0f;
+    list.setMat4(0, first);
+    list.setVec3(1, glm::vec3(1.0f, 2.0f, 3.0f));
+    list.setMat4(2, second);
+    list.blitToDefault(4, 320, 240, 640, 480);
+
+    const auto& commands = list.getCommands();
+    REQUIRE(commands.size() == 4);
+    CHECK(list.getMatrix(commands[0].dataIndex) == first);
+    CHECK(list.getVector(commands[1].dataIndex) == glm::vec4(1.0f, 2.0f, 3.0f, 0.0f));
+    CHECK(list.getMatrix(commands[2].dataIndex) == second);
+    CHECK(typeAt(list, 3) == RenderCommandType::BlitFramebuffer);
+    CHECK_EQUAL(4u, commands[3].handle);
+    CHECK(list.getVector(commands[3].dataIndex) == glm::vec4(0, 0, 320, 240));
+    CHECK(list.getVector(commands[3].dataIndex + 1) == glm::vec4(0, 0, 640, 480));
+}
+
+TEST(RenderCommandList_DropsUnknownUniformLocations) {
+    RenderCommandList list;
+    list.setInt(-1, 1);
+    list.setFloat(-1, 1.0f);
+    list.setVec3(-1, glm::vec3(1.0f));
+    list.setMat4(-1, glm::mat4(1.0f));
+    CHECK(list.empty());
+}
+
+TEST(RenderCommandList_RunsTasksInCommandOrder) {
+    RenderCommandList list;
+    int calls = 0;
+    list.useProgram(1);
+    list.runTask([&calls] { calls += 1; });
+    list.drawIndexed(2, 3);
+    list.runTask([&calls] { calls *= 10; });
+
+    REQUIRE(list.getCommands().size() == 4);
+    CHECK(typeAt(list, 1) == RenderCommandType::RunTask);
+    CHECK(typeAt(list, 3) == RenderCommandType::RunTask);
+    for (const RenderCommand& command : list.getCommands()) {
+        if (command.type == RenderCommandType::RunTask) {
+            list.getTask(command.dataIndex)();
+        }
+    }
+    CHECK_EQUAL(10, calls);
+}
+
+TEST(RenderCommandList_ResetClearsEverything) {
+    RenderCommandList list;
+    list.reset(1);
+    list.setMat4(0, glm::mat4(1.0f));
+    list.runTask([] {});
+    list.setPresent(true);
+
+    list.reset(2);
+    CHECK(list.empty());
+    CHECK(!list.shouldPresent());
+    CHECK_EQUAL(2u, list.getFrameIndex());
+
+    // Pools start over, so indices of a re-recorded frame are the same as the first time.
+    list.setMat4(0, glm::mat4(5.0f));
+    CHECK_EQUAL(0u, list.getCommands()[0].dataIndex);
+    CHECK(list.getMatrix(0) == glm::mat4(5.0f));
+}
\ No newline at end of file
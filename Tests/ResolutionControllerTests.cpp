@@ -0,0 +1,136 @@
+#include "Test.h"
+#include "ResolutionController.h"
+
+namespace {
+    // Skips the samples that follow a change.
+    void settle(ResolutionController& controller) {
+        for (int i = 0; i < controller.getSettings().settleFrames; i++) {
+            CHECK(controller.isSettling());
+            CHECK(!controller.addSample(1000.0));
+        }
+        CHECK(!controller.isSettling());
+    }
+
+    // GPU time at scale if the full resolution frame takes fullMilliseconds.
+    double timeAt(float scale, double fullMilliseconds, double fixedMilliseconds = 0.0) {
+        return fixedMilliseconds + fullMilliseconds * scale * scale;
+    }
+}
+
+TEST(ResolutionController_StartsAtFullScale) {
+    ResolutionController controller;
+    CHECK_EQUAL(1.0f, controller.getScale());
+    CHECK(!controller.isSettling());
+    CHECK(!controller.addSample(10.0));
+    CHECK(!controller.addSample(0.0));
+    CHECK_EQUAL(1.0f, controller.getScale());
+}
+
+TEST(ResolutionController_StepsDownAtOnceBelowHeadroom) {
+    ResolutionController controller;
+    // Twice the target: sqrt(0.85 / 2) = 0.652, rounded down to a step.
+    CHECK(controller.addSample(2.0 * controller.getSettings().targetMilliseconds));
+    CHECK_NEAR(0.65, controller.getScale(), 1e-5);
+    CHECK(controller.isSettling());
+}
+
+TEST(ResolutionController_StepDownIsClampedToMinimum) {
+    ResolutionController controller;
+    CHECK(controller.addSample(500.0));
+    CHECK_NEAR(controller.getSettings().minScale, controller.getScale(), 1e-5);
+}
+
+TEST(ResolutionController_IgnoresSamplesWhileSettling) {
+    ResolutionController controller;
+    CHECK(controller.addSample(500.0));
+    float scale = controller.getScale();
+    // Even samples that would change the scale again are dropped: they may have been
+    // measured before the change reached the GPU.
+    settle(controller);
+    CHECK_EQUAL(scale, controller.getScale());
+    CHECK_EQUAL(0.0, controller.getAverageMilliseconds());
+}
+
+TEST(ResolutionController_StepsUpAtMostMaxGrowSteps) {
+    ResolutionController controller;
+    const ResolutionControllerSettings& settings = controller.getSettings();
+    CHECK(controller.addSample(500.0));
+    settle(controller);
+
+    CHECK(controller.addSample(1.0));
+    CHECK_NEAR(settings.minScale + settings.maxGrowSteps * settings.scaleStep, controller.getScale(), 1e-5);
+    settle(controller);
+    CHECK(controller.addSample(1.0));
+    CHECK_NEAR(settings.minScale + 2 * settings.maxGrowSteps * settings.scaleStep, controller.getScale(), 1e-5);
+}
+
+TEST(ResolutionController_DoesNotGrowInsideHeadroom) {
+    ResolutionController controller;
+    const double target = controller.getSettings().targetMilliseconds;
+    CHECK(controller.addSample(2.0 * target));
+    settle(controller);
+
+    // Under the target but above 85% of it: growing would overshoot, shrinking is not needed.
+    for (int i = 0; i < 100; i++) {
+        CHECK(!controller.addSample(0.95 * target));
+    }
+    CHECK_NEAR(0.65, controller.getScale(), 1e-5);
+}
+
+// A GPU whose cost follows the pixel count ends up at one scale and stays there.
+TEST(ResolutionController_SettlesWithoutOscillating) {
+    for (double fullMilliseconds : { 17.0, 20.0, 30.0, 45.0 }) {
+        ResolutionController controller;
+        int changes = 0;
+        int lastChange = 0;
+        for (int frame = 0; frame < 600; frame++) {
+            if (controller.addSample(timeAt(controller.getScale(), fullMilliseconds))) {
+                changes++;
+                lastChange = frame;
+            }
+        }
+        CHECK(changes <= 4);
+        CHECK(lastChange < 100);
+        CHECK(timeAt(controller.getScale(), fullMilliseconds) <= controller.getSettings().targetMilliseconds);
+    }
+}
+
+// Part of the timed work does not shrink with the scale (the copy to the window, draw
+// call overhead): the controller needs more steps down but still ends within the
+// target when that is possible at all, and does not fall to the minimum when a
+// larger scale fits.
+TEST(ResolutionController_SettlesWithFixedCost) {
+    for (double fixedMilliseconds : { 2.0, 5.0, 10.0 }) {
+        for (double fullMilliseconds : { 20.0, 30.0, 45.0 }) {
+            ResolutionController controller;
+            const ResolutionControllerSettings& settings = controller.getSettings();
+            int changes = 0;
+            int lastChange = 0;
+            for (int frame = 0; frame < 600; frame++) {
+                if (controller.addSample(timeAt(controller.getScale(), fullMilliseconds, fixedMilliseconds))) {
+                    changes++;
+                    lastChange = frame;
+                }
+            }
+            CHECK(changes <= 8);
+            CHECK(lastChange < 200);
+            if (timeAt(settings.minScale, fullMilliseconds, fixedMilliseconds) > settings.targetMilliseconds) {
+                CHECK_EQUAL(settings.minScale, controller.getScale());
+                continue;
+            }
+            CHECK(timeAt(controller.getScale(), fullMilliseconds, fixedMilliseconds) <= settings.targetMilliseconds);
+            if (timeAt(settings.minScale + settings.scaleStep, fullMilliseconds, fixedMilliseconds) <
+                settings.headroom * settings.targetMilliseconds) {
+                CHECK(controller.getScale() > settings.minScale);
+            }
+        }
+    }
+}
+
+TEST(ResolutionController_ResetReturnsToFullScale) {
+    ResolutionController controller;
+    CHECK(controller.addSample(500.0));
+    controller.reset();
+    CHECK_EQUAL(1.0f, controller.getScale());
+    CHECK(!controller.isSettling());
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "Test.h"
+#include "AllocationCounter.h"
+#include "RenderBackend.h"
+#include "Scene.h"
+
+// Runs the real update/record/execute loop with the GL and GLFW entry points replaced
+// by the stubs in GLStubs.cpp, so this needs neither a window nor a GPU.
+TEST(Scene_SteadyFramesDoNotAllocate) {
+    const int MAX_WARMUP_FRAMES = 2000;
+    const int MEASURED_FRAMES = 60;
+
+    REQUIRE(AllocationCounter::isEnabled());
+
+    JobSystem jobs(2);
+    Scene scene(jobs, "Data/steady.scene");
+    RenderBackend backend;
+    RenderCommandList list;
+    uint64_t frame = 0;
+
+    auto runFrame = [&] {
+        scene.update(nullptr, 1.0f / 60.0f);
+        list.reset(frame++);
+        scene.record(list);
+        backend.execute(list);
+    };
+
+    while (!scene.isSteadyState() && frame < MAX_WARMUP_FRAMES) {
+        runFrame();
+    }
+    REQUIRE(scene.isSteadyState());
+
+    uint64_t before = AllocationCounter::threadAllocations();
+    for (int i = 0; i < MEASURED_FRAMES; i++) {
+        runFrame();
+    }
+    uint64_t allocations = AllocationCounter::threadAllocations() - before;
+
+    CHECK_EQUAL(0u, allocations);
+    CHECK(scene.isSteadyState());
+    CHECK(scene.getStats().lastMainPassDraws > 0);
+}
\ No newline at end of file
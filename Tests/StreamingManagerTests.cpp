@@ -0,0 +1,65 @@
+#include "Test.h"
+#include "StreamingManager.h"
+#include <chrono>
+#include <thread>
+
+namespace {
+    // Two rooms side by side; the model belongs to the second one.
+    SceneDescription makeScene(bool required) {
+        SceneDescription scene;
+        RoomDescription first;
+        first.name = "First";
+        first.center = glm::vec3(0.0f);
+        first.size = glm::vec3(10.0f);
+        first.neighbours = { 1 };
+        RoomDescription second = first;
+        second.name = "Second";
+        second.center = glm::vec3(10.0f, 0.0f, 0.0f);
+        second.neighbours = { 0 };
+        scene.rooms = { first, second };
+
+        ModelDescription model;
+        model.objPath = "Data/missing.obj";
+        model.mtlBaseDir = "Data/";
+        model.room = 1;
+        model.required = required;
+        scene.models.push_back(model);
+        return scene;
+    }
+
+    // Runs update until the background load of the model has come back.
+    void streamUntilIdle(StreamingManager& streaming, const glm::vec3& position) {
+        streaming.update(position);
+        for (int i = 0; i < 1000 && streaming.isBusy(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            streaming.update(position);
+        }
+    }
+}
+
+TEST(StreamingManager_RequiredModelFailsAtStartup) {
+    JobSystem jobs(2);
+    RenderStats stats;
+    SceneDescription scene = makeScene(true);
+    StreamingManager streaming(jobs, scene, stats);
+    CHECK_THROWS(streaming.loadNow(glm::vec3(10.0f, 0.0f, 0.0f)));
+}
+
+TEST(StreamingManager_RequiredModelFailsWhenStreamedIn) {
+    JobSystem jobs(2);
+    RenderStats stats;
+    SceneDescription scene = makeScene(true);
+    StreamingManager streaming(jobs, scene, stats);
+    // The model is a neighbour of the first room, so it is prefetched in the background.
+    CHECK_THROWS(streamUntilIdle(streaming, glm::vec3(0.0f)));
+}
+
+TEST(StreamingManager_OptionalModelIsSkipped) {
+    JobSystem jobs(2);
+    RenderStats stats;
+    SceneDescription scene = makeScene(false);
+    StreamingManager streaming(jobs, scene, stats);
+    streamUntilIdle(streaming, glm::vec3(0.0f));
+    CHECK(!streaming.isBusy());
+    CHECK_EQUAL(0u, stats.modelsStreamedIn);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal test runner. TEST(name) registers a function; CHECK* report a failure with
+// its location and carry on, REQUIRE stops the current test. TestMain.cpp runs every
+// registered test, or only those whose name contains the first command line argument.
+// Paths are relative to the Tests directory, like the engine's are to Muzeu3D.
+namespace Test {
+    struct Case {
+        const char* name;
+        void (*function)();
+    };
+
+    // Thrown by REQUIRE to leave the current test.
+    struct Abort {};
+
+    inline std::vector<Case>& cases() {
+        static std::vector<Case> all;
+        return all;
+    }
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const std::string& message) {
+        std::cerr << file << "(" << line << "): " << message << "\n";
+        failures()++;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, void (*function)()) {
+            cases().push_back(Case{ name, function });
+        }
+    };
+}
+
+#define TEST(name) \
+    static void name(); \
+    static Test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) Test::fail(__FILE__, __LINE__, "CHECK(" #condition ") failed"); \
+    } while (0)
+
+#define REQUIRE(condition) \
+    do { \
+        if (!(condition)) { \
+            Test::fail(__FILE__, __LINE__, "REQUIRE(" #condition ") failed"); \
+            throw Test::Abort(); \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+    do { \
+        auto expectedValue = (expected); \
+        auto actualValue = (actual); \
+        if (!(expectedValue == actualValue)) { \
+            std::ostringstream message; \
+            message << "CHECK_EQUAL(" #expected ", " #actual "): expected " << expectedValue << ", got " << actualValue; \
+            Test::fail(__FILE__, __LINE__, message.str()); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(expected, actual, tolerance) \
+    do { \
+        double expectedValue = (expected); \
+        double actualValue = (actual); \
+        if (!(std::fabs(expectedValue - actualValue) <= (tolerance))) { \
+            std::ostringstream message; \
+            message << "CHECK_NEAR(" #expected ", " #actual "): expected " << expectedValue << ", got " << actualValue; \
+            Test::fail(__FILE__, __LINE__, message.str()); \
+        } \
+    } while (0)
+
+#define CHECK_THROWS(expression) \
+    do { \
+        bool threw = false; \
+        try { expression; } \
+        catch (...) { threw = true; } \
+        if (!threw) Test::fail(__FILE__, __LINE__, "CHECK_THROWS(" #expression ") did not throw"); \
+    } while (0)
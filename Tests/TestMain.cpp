@@ -0,0 +1,35 @@
+#include "Test.h"
+#include <cstring>
+#include <exception>
+
+// Usage: Tests [filter]; returns non-zero if any test failed.
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+    int failed = 0;
+
+    for (const Test::Case& test : Test::cases()) {
+        if (filter && !std::strstr(test.name, filter)) continue;
+
+        int failuresBefore = Test::failures();
+        try {
+            test.function();
+        }
+        catch (const Test::Abort&) {
+        }
+        catch (const std::exception& e) {
+            Test::fail(test.name, 0, std::string("unexpected exception: ") + e.what());
+        }
+        catch (...) {
+            Test::fail(test.name, 0, "unexpected exception");
+        }
+
+        bool passed = Test::failures() == failuresBefore;
+        std::cout << (passed ? "[  OK  ] " : "[ FAIL ] ") << test.name << "\n";
+        run++;
+        failed += passed ? 0 : 1;
+    }
+
+    std::cout << run - failed << " of " << run << " tests passed\n";
+    return failed ? 1 : 0;
+}
\ No newline at end of file